@@ -0,0 +1,167 @@
+#include <benchmark/benchmark.h>
+
+#include <dcel_polygon2d.h>
+#include <decompose_to_monotones.h>
+#include <polygon2d.h>
+#include <resolve_intersections.h>
+#include <triangulate_monotone.h>
+#include <triangulation.h>
+
+#include <cmath>
+#include <cstdint>
+#include <list>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Sizes of simple polygons, every stage is expected to be O(NlogN) on them
+constexpr int64_t kMinSize = 1 << 8;
+constexpr int64_t kMaxSize = 1 << 17;
+
+// Simple star-shaped polygon with jagged radius,
+// so it has plenty of split and merge vertices
+std::vector<geom::Point2D> StarPolygon(size_t size) {
+  std::vector<geom::Point2D> polygon_v;
+  polygon_v.reserve(size);
+  const double step = 2 * M_PI / size;
+  for (size_t i = 0; i < size; i++) {
+    const double distance = i % 2 ? 1e3 : 5e2 + 1e2 * (i % 7);
+    polygon_v.push_back({distance * std::cos(step * i),
+                         distance * std::sin(step * i)});
+  }
+  return polygon_v;
+}
+
+// y-monotone polygon with jagged left and right chains
+std::vector<geom::Point2D> YMonotonePolygon(size_t size) {
+  std::vector<geom::Point2D> polygon_v;
+  polygon_v.reserve(size);
+  const size_t chain_size = size / 2;
+  for (size_t i = 0; i < chain_size; i++)
+    polygon_v.push_back({1e3 + 1e2 * (i % 3), static_cast<double>(i)});
+  for (size_t i = chain_size; i < size; i++)
+    polygon_v.push_back({-1e3 - 1e2 * (i % 5),
+                         static_cast<double>(size - i)});
+  return polygon_v;
+}
+
+// Random points, number of self-intersections grows as O(N^2)
+std::vector<geom::Point2D> RandomPolygon(size_t size) {
+  std::mt19937 generator(size);
+  std::uniform_real_distribution<double> distribution(0, 100);
+  std::vector<geom::Point2D> polygon_v;
+  polygon_v.reserve(size);
+  for (size_t i = 0; i < size; i++)
+    polygon_v.push_back({distribution(generator), distribution(generator)});
+  return polygon_v;
+}
+
+void SetProcessed(benchmark::State& state) {
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.SetComplexityN(state.range(0));
+}
+
+void BM_Polygon2DConstruction(benchmark::State& state) {
+  const std::vector<geom::Point2D> polygon_v = StarPolygon(state.range(0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(geom::Polygon2D(polygon_v));
+  SetProcessed(state);
+}
+BENCHMARK(BM_Polygon2DConstruction)
+    ->RangeMultiplier(4)->Range(kMinSize, kMaxSize)
+    ->Complexity(benchmark::oNLogN);
+
+void BM_ResolveIntersectionsSimple(benchmark::State& state) {
+  const geom::Polygon2D polygon(StarPolygon(state.range(0)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(geom::ResolveIntersections(polygon));
+  SetProcessed(state);
+}
+BENCHMARK(BM_ResolveIntersectionsSimple)
+    ->RangeMultiplier(4)->Range(kMinSize, kMaxSize)
+    ->Complexity(benchmark::oNLogN);
+
+void BM_ResolveIntersectionsRandom(benchmark::State& state) {
+  const geom::Polygon2D polygon(RandomPolygon(state.range(0)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(geom::ResolveIntersections(polygon));
+  SetProcessed(state);
+}
+BENCHMARK(BM_ResolveIntersectionsRandom)
+    ->RangeMultiplier(2)->Range(16, 256)
+    ->Complexity();
+
+void BM_DecomposeToYMonotones(benchmark::State& state) {
+  const geom::Polygon2D polygon(StarPolygon(state.range(0)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(geom::DecomposeToYMonotones(polygon));
+  SetProcessed(state);
+}
+BENCHMARK(BM_DecomposeToYMonotones)
+    ->RangeMultiplier(4)->Range(kMinSize, kMaxSize)
+    ->Complexity(benchmark::oNLogN);
+
+void BM_TriangulateYMonotone(benchmark::State& state) {
+  const geom::Polygon2D polygon(YMonotonePolygon(state.range(0)));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(geom::TriangulateYMonotone(polygon));
+  SetProcessed(state);
+}
+BENCHMARK(BM_TriangulateYMonotone)
+    ->RangeMultiplier(4)->Range(kMinSize, kMaxSize)
+    ->Complexity(benchmark::oNLogN);
+
+// Convex polygon split into a fan of triangles by diagonals
+void BM_GetPolygons(benchmark::State& state) {
+  const size_t size = state.range(0);
+  std::vector<geom::Point2D> polygon_v;
+  polygon_v.reserve(size);
+  const double step = 2 * M_PI / size;
+  for (size_t i = 0; i < size; i++)
+    polygon_v.push_back({1e3 * std::cos(step * i), 1e3 * std::sin(step * i)});
+  geom::DcelPolygon2D dcel_polygon(geom::Polygon2D{polygon_v});
+  for (size_t i = 2; i + 1 < size; i++)
+    dcel_polygon.InsertEdge({polygon_v[0], polygon_v[i]});
+
+  for (auto _ : state)
+    benchmark::DoNotOptimize(dcel_polygon.GetPolygons());
+  SetProcessed(state);
+}
+BENCHMARK(BM_GetPolygons)
+    ->RangeMultiplier(4)->Range(kMinSize, kMaxSize)
+    ->Complexity(benchmark::oNLogN);
+
+void BM_Triangulate(benchmark::State& state) {
+  const std::vector<geom::Point2D> polygon_v = StarPolygon(state.range(0));
+  for (auto _ : state)
+    benchmark::DoNotOptimize(geom::Triangulate(polygon_v));
+  SetProcessed(state);
+}
+BENCHMARK(BM_Triangulate)
+    ->RangeMultiplier(4)->Range(kMinSize, kMaxSize)
+    ->Complexity(benchmark::oNLogN);
+
+// Whole calls on small polygons, where per-call overhead dominates
+// Crossing points of the engines are the defaults of
+// ear_clipping_threshold and simple_ear_clipping_threshold (known_simple)
+void BM_TriangulateSmall(benchmark::State& state) {
+  const std::vector<geom::Point2D> polygon_v = StarPolygon(state.range(0));
+  geom::TriangulationOptions options;
+  options.engine =
+      static_cast<geom::TriangulationOptions::Engine>(state.range(1));
+  options.known_simple = state.range(2);
+  for (auto _ : state)
+    benchmark::DoNotOptimize(geom::Triangulate(polygon_v, options));
+  SetProcessed(state);
+}
+BENCHMARK(BM_TriangulateSmall)
+    ->ArgNames({"size", "engine", "known_simple"})
+    ->ArgsProduct({{8, 16, 24, 32, 40, 48, 64, 128},
+                   {geom::TriangulationOptions::MONOTONE_ENGINE,
+                    geom::TriangulationOptions::EAR_CLIPPING_ENGINE},
+                   {false, true}});
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <ear_clipping.h>
+#include <polygon2d.h>
+#include <polygon_shape.h>
+#include <test_utils/decomposition_utils.h>
+#include <test_utils/triangulate_utils.h>
+
+#include <cmath>
+#include <optional>
+#include <vector>
+
+namespace decomposition_tests {
+
+TEST_P(EarClippingTest, TriangulateByEarClipping) {
+  geom::Polygon2D polygon(GetParam());
+  ASSERT_TRUE(geom::IsSimpleBruteForce(polygon));
+  std::optional<std::pmr::vector<geom::VertexTriangle> > triangles =
+      geom::TriangulateByEarClipping(polygon);
+  ASSERT_TRUE(triangles);
+  for (const geom::VertexTriangle& vertices : *triangles) {
+    const geom::Triangle2D triangle = polygon.Triangle(vertices);
+    answer_.push_back(geom::Polygon2D({triangle.a, triangle.b, triangle.c}));
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Decomposition,
+                         EarClippingTest,
+                         testing::ValuesIn(test_polygons));
+
+TEST(EarClippingDegenerateTest, CollinearVertices) {
+  // Square with extra vertices on its sides
+  const geom::Polygon2D polygon(std::vector<geom::Point2D>{
+      {0, 0}, {1, 0}, {2, 0}, {2, 1}, {2, 2}, {0, 2}, {0, 1}});
+  EXPECT_TRUE(geom::IsSimpleBruteForce(polygon));
+  std::optional<std::pmr::vector<geom::VertexTriangle> > triangles =
+      geom::TriangulateByEarClipping(polygon);
+  ASSERT_TRUE(triangles);
+  EXPECT_EQ(triangles->size(), 5);
+}
+
+TEST(EarClippingDegenerateTest, PinchedAtVertex) {
+  // Two triangles touching at (0, 0)
+  const geom::Polygon2D polygon(std::vector<geom::Point2D>{
+      {0, 0}, {-1, 1}, {1, 1}, {0, 0}, {1, -1}, {-1, -1}});
+  EXPECT_FALSE(geom::IsSimpleBruteForce(polygon));
+  std::optional<std::pmr::vector<geom::VertexTriangle> > triangles =
+      geom::TriangulateByEarClipping(polygon);
+  ASSERT_TRUE(triangles);
+  EXPECT_EQ(triangles->size(), 2);
+}
+
+TEST(EarClippingDegenerateTest, SelfIntersecting) {
+  for (const std::vector<geom::Point2D>& polygon_v :
+       self_intersecting_polygons)
+    EXPECT_FALSE(geom::IsSimpleBruteForce(geom::Polygon2D(polygon_v)));
+
+  // Edges touching without crossing
+  EXPECT_FALSE(geom::IsSimpleBruteForce(geom::Polygon2D(
+      std::vector<geom::Point2D>{{0, 0}, {4, 0}, {4, 4}, {2, 0}, {0, 4}})));
+}
+
+TEST(EarClippingCacheTest, EarsOnlyAtEnds) {
+  // Thin arc-shaped band, every outer vertex has an inner one
+  // in its triangle, so the ears are at the ends of the band only
+  constexpr size_t kArcSize = 200;
+  const double step = 5.0 / (kArcSize - 1);
+  const double width = 0.3 * 1000 * (1 - std::cos(2 * step));
+  std::vector<geom::Point2D> polygon_v;
+  for (size_t i = 0; i < kArcSize; i++)
+    polygon_v.push_back({1000 * std::cos(i * step),
+                         1000 * std::sin(i * step)});
+  for (size_t i = kArcSize; i-- > 0;)
+    polygon_v.push_back({(1000 - width) * std::cos(i * step),
+                         (1000 - width) * std::sin(i * step)});
+  const geom::Polygon2D polygon(polygon_v);
+  std::optional<std::pmr::vector<geom::VertexTriangle> > triangles =
+      geom::TriangulateByEarClipping(polygon);
+  ASSERT_TRUE(triangles);
+  EXPECT_EQ(triangles->size(), polygon_v.size() - 2);
+
+  double polygon_area = 0;
+  for (size_t i = 0; i < polygon_v.size(); i++) {
+    const geom::Point2D& a = polygon_v[i];
+    const geom::Point2D& b = polygon_v[(i + 1) % polygon_v.size()];
+    polygon_area += (a.x * b.y - a.y * b.x) / 2;
+  }
+  double triangles_area = 0;
+  for (const geom::VertexTriangle& vertices : *triangles) {
+    const geom::Triangle2D triangle = polygon.Triangle(vertices);
+    triangles_area += std::abs((triangle.b.x - triangle.a.x) *
+                                   (triangle.c.y - triangle.a.y) -
+                               (triangle.b.y - triangle.a.y) *
+                                   (triangle.c.x - triangle.a.x)) / 2;
+  }
+  EXPECT_NEAR(triangles_area, std::abs(polygon_area),
+              1e-9 * 1000 * 1000);
+}
+
+}  // decomposition_tests
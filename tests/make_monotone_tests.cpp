@@ -6,7 +6,9 @@
 #include <polygon2d.h>
 #include <test_utils/decomposition_utils.h>
 
+#include <iterator>
 #include <list>
+#include <vector>
 
 namespace decomposition_tests {
 
@@ -16,10 +18,9 @@ class MakeMonotoneDecompositionTest :
   bool IsMonotone(const geom::Polygon2D& polygon) {
     if (polygon.Size() < 3)
       return true;
-    const geom::Polygon2D::Vertex* current = polygon.GetAnyVertex();
-    for (size_t i = 0; i < polygon.Size(); i++, current = current->next) {
-      if (current->type == geom::Polygon2D::SPLIT ||
-          current->type == geom::Polygon2D::MERGE)
+    for (size_t i = 0; i < polygon.Size(); i++) {
+      if (polygon.Type(i) == geom::Polygon2D::SPLIT ||
+          polygon.Type(i) == geom::Polygon2D::MERGE)
         return false;
     }
     return true;
@@ -28,8 +29,8 @@ class MakeMonotoneDecompositionTest :
 
 TEST_P(MakeMonotoneDecompositionTest, DecomposeToYMonotones) {
   geom::Polygon2D polygon(GetParam());
-  std::list<geom::Polygon2D> res_polygons =
-    geom::DecomposeToYMonotones(geom::AsVector(polygon));
+  std::pmr::list<geom::Polygon2D> res_polygons =
+    geom::DecomposeToYMonotones(polygon);
   size_t original_size = polygon.Size();
   size_t res_size = res_polygons.size();
   size_t res_sum_size = 0;
@@ -44,4 +45,31 @@ INSTANTIATE_TEST_SUITE_P(Decomposition,
                          MakeMonotoneDecompositionTest,
                          testing::ValuesIn(test_polygons));
 
+TEST(HolesDecompositionTest, DecomposeToYMonotones) {
+  const geom::Polygon2D polygon(polygon_with_holes[0]);
+  std::pmr::vector<geom::Polygon2D> holes;
+  size_t original_size = polygon.Size();
+  for (size_t i = 1; i < std::size(polygon_with_holes); i++) {
+    const std::vector<geom::Point2D>& hole_v = polygon_with_holes[i];
+    holes.push_back(geom::Polygon2D::HoleFromRing(
+        hole_v.data(), hole_v.data() + hole_v.size()));
+    original_size += hole_v.size();
+  }
+
+  std::pmr::list<geom::Polygon2D> res_polygons =
+      geom::DecomposeToYMonotones(polygon, holes);
+  size_t res_sum_size = 0;
+  for (const geom::Polygon2D& res_polygon : res_polygons) {
+    for (size_t i = 0; i < res_polygon.Size(); i++) {
+      EXPECT_NE(res_polygon.Type(i), geom::Polygon2D::SPLIT);
+      EXPECT_NE(res_polygon.Type(i), geom::Polygon2D::MERGE);
+    }
+    res_sum_size += res_polygon.Size();
+  }
+  // Every diagonal adds two vertices, first one per hole
+  // connects it without adding a piece
+  EXPECT_EQ(original_size, res_sum_size -
+      2 * (res_polygons.size() - 1 + holes.size()));
+}
+
 }  // decomposition_tests
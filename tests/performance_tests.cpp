@@ -65,6 +65,12 @@ TEST_P(RandomPolygonPerformanceTest, Triangulation) {
   geom::Triangulate(polygon_v_);
 }
 
+TEST_P(RandomPolygonPerformanceTest, ParallelTriangulation) {
+  geom::TriangulationOptions options;
+  options.num_threads = 0;
+  geom::Triangulate(polygon_v_, options);
+}
+
 INSTANTIATE_TEST_SUITE_P(Performance,
                          RandomPolygonPerformanceTest,
                          testing::ValuesIn(random_polygon_test_sizes));
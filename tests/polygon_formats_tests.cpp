@@ -0,0 +1,223 @@
+#include <gtest/gtest.h>
+
+#include <polygon_formats.h>
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace decomposition_tests {
+
+namespace {
+
+// Encoders of the test data, byte order is chosen per value
+class Bytes {
+ public:
+  Bytes& Uint8(uint8_t value) {
+    data_.push_back(static_cast<char>(value));
+    return *this;
+  }
+
+  Bytes& Uint32(uint32_t value, bool little_endian = true) {
+    return Unsigned(value, 4, little_endian);
+  }
+
+  Bytes& Double(double value, bool little_endian = true) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return Unsigned(bits, 8, little_endian);
+  }
+
+  const std::string& Data() const { return data_; }
+
+ private:
+  Bytes& Unsigned(uint64_t value, size_t size, bool little_endian) {
+    for (size_t i = 0; i < size; i++) {
+      const size_t byte = little_endian ? i : size - 1 - i;
+      data_.push_back(static_cast<char>(value >> (8 * byte)));
+    }
+    return *this;
+  }
+
+  std::string data_;
+};
+
+std::vector<geom::InputPolygon> ReadAll(geom::PolygonFormat format,
+                                        const std::string& data,
+                                        std::string* error = nullptr) {
+  std::unique_ptr<geom::PolygonReader> reader =
+      geom::MakePolygonReader(format, data.data(), data.size());
+  std::vector<geom::InputPolygon> polygons;
+  geom::InputPolygon polygon;
+  while (reader->Next(&polygon))
+    polygons.push_back(polygon);
+  if (error)
+    *error = reader->Error();
+  else
+    EXPECT_EQ(reader->Error(), "");
+  return polygons;
+}
+
+void ExpectRing(const std::vector<geom::Point2D>& ring,
+                const std::vector<geom::Point2D>& expected) {
+  ASSERT_EQ(ring.size(), expected.size());
+  for (size_t i = 0; i < ring.size(); i++) {
+    EXPECT_EQ(ring[i].x, expected[i].x);
+    EXPECT_EQ(ring[i].y, expected[i].y);
+  }
+}
+
+const std::vector<geom::Point2D> kSquare = {{0, 0}, {4, 0}, {4, 4}, {0, 4}};
+const std::vector<geom::Point2D> kHole = {{1, 1}, {1, 2}, {2, 2}};
+const std::vector<geom::Point2D> kTriangle = {{5, 5}, {7, 5}, {6, 8}};
+
+// WKB polygon with closed rings and dimensions - 2 extra coordinates
+void AppendWkbPolygon(const std::vector<std::vector<geom::Point2D> >& rings,
+                      uint32_t type, size_t dimensions, bool little_endian,
+                      Bytes* bytes) {
+  bytes->Uint8(little_endian).Uint32(type, little_endian);
+  bytes->Uint32(static_cast<uint32_t>(rings.size()), little_endian);
+  for (const std::vector<geom::Point2D>& ring : rings) {
+    bytes->Uint32(static_cast<uint32_t>(ring.size() + 1), little_endian);
+    for (size_t i = 0; i <= ring.size(); i++) {
+      const geom::Point2D& point = ring[i % ring.size()];
+      bytes->Double(point.x, little_endian).Double(point.y, little_endian);
+      for (size_t j = 2; j < dimensions; j++)
+        bytes->Double(100, little_endian);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(PolygonFormatsTest, FlatBinary) {
+  Bytes bytes;
+  bytes.Uint32(2);
+  bytes.Uint32(2).Uint32(4);
+  for (const geom::Point2D& point : kSquare)
+    bytes.Double(point.x).Double(point.y);
+  bytes.Uint32(3);
+  for (const geom::Point2D& point : kHole)
+    bytes.Double(point.x).Double(point.y);
+  bytes.Uint32(1).Uint32(3);
+  for (const geom::Point2D& point : kTriangle)
+    bytes.Double(point.x).Double(point.y);
+
+  const std::vector<geom::InputPolygon> polygons =
+      ReadAll(geom::FLAT_BINARY_FORMAT, bytes.Data());
+  ASSERT_EQ(polygons.size(), 2);
+  ExpectRing(polygons[0].ring, kSquare);
+  ASSERT_EQ(polygons[0].holes.size(), 1);
+  ExpectRing(polygons[0].holes[0], kHole);
+  ExpectRing(polygons[1].ring, kTriangle);
+  EXPECT_TRUE(polygons[1].holes.empty());
+
+  EXPECT_TRUE(ReadAll(geom::FLAT_BINARY_FORMAT, "").empty());
+
+  // Second polygon is cut in the middle of its points
+  std::string error;
+  const std::string truncated =
+      bytes.Data().substr(0, bytes.Data().size() - 4);
+  EXPECT_EQ(ReadAll(geom::FLAT_BINARY_FORMAT, truncated, &error).size(), 1);
+  EXPECT_NE(error, "");
+}
+
+TEST(PolygonFormatsTest, Wkb) {
+  Bytes bytes;
+  // Polygon with a hole, big-endian
+  AppendWkbPolygon({kSquare, kHole}, 3, 2, false, &bytes);
+  // Point is skipped
+  bytes.Uint8(1).Uint32(1).Double(1).Double(2);
+  // MultiPolygon of ISO Z polygon and EWKB ZM polygon with SRID
+  bytes.Uint8(1).Uint32(6).Uint32(2);
+  AppendWkbPolygon({kTriangle}, 1003, 3, true, &bytes);
+  Bytes ewkb;
+  ewkb.Uint8(1).Uint32(0xE0000003).Uint32(4326).Uint32(1).Uint32(4);
+  for (size_t i = 0; i <= kTriangle.size(); i++)
+    ewkb.Double(kTriangle[i % 3].x).Double(kTriangle[i % 3].y)
+        .Double(10).Double(20);
+
+  const std::vector<geom::InputPolygon> polygons =
+      ReadAll(geom::WKB_FORMAT, bytes.Data() + ewkb.Data());
+  ASSERT_EQ(polygons.size(), 3);
+  ExpectRing(polygons[0].ring, kSquare);
+  ASSERT_EQ(polygons[0].holes.size(), 1);
+  ExpectRing(polygons[0].holes[0], kHole);
+  ExpectRing(polygons[1].ring, kTriangle);
+  ExpectRing(polygons[2].ring, kTriangle);
+
+  std::string error;
+  EXPECT_TRUE(ReadAll(geom::WKB_FORMAT, "\x01\x03\x00", &error).empty());
+  EXPECT_NE(error, "");
+  // Unknown geometry type
+  Bytes unknown;
+  unknown.Uint8(1).Uint32(17);
+  EXPECT_TRUE(ReadAll(geom::WKB_FORMAT, unknown.Data(), &error).empty());
+  EXPECT_NE(error, "");
+}
+
+TEST(PolygonFormatsTest, GeoJson) {
+  const std::string data = R"({
+    "type": "FeatureCollection",
+    "features": [
+      {"type": "Feature", "properties": {"name": "a \"quoted\" name",
+                                         "list": [1, true, null]},
+       "geometry": {"coordinates": [[[0, 0], [4, 0], [4, 4], [0, 4],
+                                     [0, 0]],
+                                    [[1, 1], [1, 2], [2, 2], [1, 1]]],
+                    "type": "Polygon"}},
+      {"type": "Feature", "properties": null,
+       "geometry": {"type": "MultiPolygon",
+                    "coordinates": [[[[5, 5, 1], [7, 5, 1], [6, 8, 1]]],
+                                    [[[5e0, 5], [7.0, 5], [6, 8]]]]}},
+      {"type": "Feature", "properties": {},
+       "geometry": {"type": "LineString", "coordinates": [[0, 0], [1, 1]]}}
+    ]
+  })";
+  const std::vector<geom::InputPolygon> polygons =
+      ReadAll(geom::GEOJSON_FORMAT, data);
+  ASSERT_EQ(polygons.size(), 3);
+  ExpectRing(polygons[0].ring, kSquare);
+  ASSERT_EQ(polygons[0].holes.size(), 1);
+  ExpectRing(polygons[0].holes[0], kHole);
+  ExpectRing(polygons[1].ring, kTriangle);
+  ExpectRing(polygons[2].ring, kTriangle);
+
+  std::string error;
+  EXPECT_TRUE(ReadAll(geom::GEOJSON_FORMAT,
+                      R"({"type": "Polygon", "coordinates": [[[0, 0], [1)",
+                      &error).empty());
+  EXPECT_NE(error, "");
+  EXPECT_TRUE(ReadAll(geom::GEOJSON_FORMAT,
+                      R"({"type": "Polygon", "coordinates": [[0, 0]]})",
+                      &error).empty());
+  EXPECT_NE(error, "");
+}
+
+TEST(PolygonFormatsTest, FormatOfPath) {
+  EXPECT_EQ(geom::PolygonFormatOfPath("layer.bin"), geom::FLAT_BINARY_FORMAT);
+  EXPECT_EQ(geom::PolygonFormatOfPath("dir.v2/layer.WKB"), geom::WKB_FORMAT);
+  EXPECT_EQ(geom::PolygonFormatOfPath("layer.geojson"),
+            geom::GEOJSON_FORMAT);
+  EXPECT_EQ(geom::PolygonFormatOfPath("layer"), geom::UNKNOWN_FORMAT);
+  EXPECT_EQ(geom::PolygonFormatOfName("wkb"), geom::WKB_FORMAT);
+}
+
+TEST(PolygonFormatsTest, IndexedMesh) {
+  geom::IndexedTriangles2D mesh;
+  mesh.points = {{0, 0}, {1, 0}, {0, 1}};
+  mesh.indices = {0, 2, 1};
+  std::vector<char> out = {'x'};
+  geom::AppendIndexedMesh(mesh, &out);
+
+  Bytes expected;
+  expected.Uint8('x').Uint32(3).Uint32(3);
+  for (const geom::Point2D& point : mesh.points)
+    expected.Double(point.x).Double(point.y);
+  expected.Uint32(0).Uint32(2).Uint32(1);
+  EXPECT_EQ(std::string(out.begin(), out.end()), expected.Data());
+}
+
+}  // decomposition_tests
@@ -16,13 +16,12 @@ namespace decomposition_tests {
 
 namespace {
 
-std::list<geom::Polygon2D> FindAnswer(const geom::Polygon2D& polygon) {
+std::pmr::list<geom::Polygon2D> FindAnswer(const geom::Polygon2D& polygon) {
   geom::DcelPolygon2D dcel_polygon(polygon);
 
   std::vector<geom::Segment2D> segments;
-  const geom::Polygon2D::Vertex* current = polygon.GetAnyVertex();
-  for (size_t i = 0; i < polygon.Size(); i++, current = current->next) {
-    geom::Point2D a = current->point, b = current->next->point;
+  for (size_t i = 0; i < polygon.Size(); i++) {
+    geom::Point2D a = polygon.Point(i), b = polygon.Point(polygon.Next(i));
     segments.push_back({a, b});
   }
 
@@ -69,8 +68,8 @@ std::list<geom::Polygon2D> FindAnswer(const geom::Polygon2D& polygon) {
   return dcel_polygon.GetPolygons();
 }
 
-bool EqualAnswers(const std::list<geom::Polygon2D>& answer1,
-                  const std::list<geom::Polygon2D>& answer2) {
+bool EqualAnswers(const std::pmr::list<geom::Polygon2D>& answer1,
+                  const std::pmr::list<geom::Polygon2D>& answer2) {
   if (answer1.size() != answer2.size())
     return false;
   for (const geom::Polygon2D& polygon_i : answer1) {
@@ -258,12 +257,12 @@ class ResolveIntersectionsTest :
     return expected_result_.size();
   }
 
-  const std::list<geom::Polygon2D>& GetExpectedResult() const {
+  const std::pmr::list<geom::Polygon2D>& GetExpectedResult() const {
     return expected_result_;
   }
 
-  std::list<geom::Polygon2D> expected_result_;
-  std::list<geom::Polygon2D> answer_;
+  std::pmr::list<geom::Polygon2D> expected_result_;
+  std::pmr::list<geom::Polygon2D> answer_;
 };
 
 TEST_P(ResolveIntersectionsTest, ResolveIntersections) {
@@ -286,8 +285,8 @@ TEST(FuzzingTest, ResolveIntersections) {
     for (size_t j = 0; j < case_size; j++)
       polygon_v.push_back({DoubleRand(0, 100), DoubleRand(0, 100)});
     const geom::Polygon2D polygon(polygon_v);
-    const std::list<geom::Polygon2D> expected_answer = FindAnswer(polygon);
-    const std::list<geom::Polygon2D> actual_answer =
+    const std::pmr::list<geom::Polygon2D> expected_answer = FindAnswer(polygon);
+    const std::pmr::list<geom::Polygon2D> actual_answer =
         geom::ResolveIntersections(polygon);
     EXPECT_TRUE(EqualAnswers(expected_answer, actual_answer));
   }
@@ -15,19 +15,23 @@ bool PolygonEqual(const geom::Polygon2D& lhp,
                   const geom::Polygon2D& rhp) {
   if (lhp.Size() != rhp.Size())
     return false;
-  const geom::Polygon2D::Vertex* lh_vertex = lhp.GetAnyVertex();
-  const geom::Polygon2D::Vertex* rh_vertex = lhp.GetAnyVertex();
-  geom::Segment2D lh_edge = {lh_vertex->point, lh_vertex->next->point};
-  geom::Segment2D rh_edge = {rh_vertex->point, rh_vertex->next->point};
-  for (size_t i = 0; i < lhp.Size(); i++, lh_vertex = lh_vertex->next) {
-    lh_edge = {lh_vertex->point, lh_vertex->next->point};
+  auto Edge = [](const geom::Polygon2D& polygon, size_t vertex) {
+    return geom::Segment2D(polygon.Point(vertex),
+                           polygon.Point(polygon.Next(vertex)));
+  };
+  size_t lh_vertex = 0;
+  size_t rh_vertex = 0;
+  geom::Segment2D lh_edge = Edge(lhp, lh_vertex);
+  geom::Segment2D rh_edge = Edge(lhp, rh_vertex);
+  for (size_t i = 0; i < lhp.Size(); i++, lh_vertex = lhp.Next(lh_vertex)) {
+    lh_edge = Edge(lhp, lh_vertex);
     if (geom::DoubleEqual(lh_edge, rh_edge))
       break;
   }
   for (size_t i = 0; i < lhp.Size();
-      i++, lh_vertex = lh_vertex->next, rh_vertex = rh_vertex->next) {
-    lh_edge = {lh_vertex->point, lh_vertex->next->point};
-    rh_edge = {rh_vertex->point, rh_vertex->next->point};
+      i++, lh_vertex = lhp.Next(lh_vertex), rh_vertex = lhp.Next(rh_vertex)) {
+    lh_edge = Edge(lhp, lh_vertex);
+    rh_edge = Edge(lhp, rh_vertex);
     if (!geom::DoubleEqual(lh_edge, rh_edge))
       return false;
   }
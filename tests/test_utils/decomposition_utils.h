@@ -59,6 +59,15 @@ const std::vector<geom::Point2D> test_polygons[] = {
   }
 };
 
+// Outer ring and holes lying inside it
+const std::vector<geom::Point2D> polygon_with_holes[] = {
+  { {0, 0}, {10, 0}, {10, 10}, {0, 10} },
+  { {2, 2}, {4, 2}, {4, 4}, {2, 4} },
+  { {6, 6}, {8, 7}, {7, 8} },
+  { {6, 1}, {8, 1}, {8, 3}, {7, 2.5}, {6, 3} }
+};
+const double polygon_with_holes_area = 91;
+
 const SimpleDecompositionCase simple_decomposition_cases[] = {
   {
     test_polygons[0],
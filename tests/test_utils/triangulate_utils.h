@@ -16,11 +16,13 @@ class TriangulationTest :
   void TearDown() override;
  
  protected:
-   std::list<geom::Polygon2D> answer_;
+   std::pmr::list<geom::Polygon2D> answer_;
 };
 
 class MonotonesTriangulationTest : public TriangulationTest {};
 
+class EarClippingTest : public TriangulationTest {};
+
 }  // decomposition_tests
 
 #endif  // TEST_UTILS_TRIANGULATE_UTILS_H
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 
+#include <geom_utils.h>
 #include <polygon2d.h>
 #include <triangulate_monotone.h>
 #include <test_utils/triangulate_utils.h>
@@ -13,12 +14,20 @@ const std::vector<geom::Point2D> y_monotone_polygons[] = {
     {3, 2}, {2.5, 1}, {0, 0}, {-3, 1.5}, {-1, 6}, {-2, 8}, {0, 10} },
   { {-1, 9}, {-1.5, 7}, {1, 5}, {-0.2, 3.5}, {-1, 2.8}, {-2, 2.5}, {-4, 2.4},
     {-3, 2}, {-2.5, 1}, {0, 0}, {3, 1.5}, {1, 6}, {2, 8}, {0, 10} },
-  { {-1, 6}, {-1, 5}, {0.2, 3.5}, {1, 2.8}, {2, 2.5}, {3, 2}, {-3, 1.5} }
+  { {-1, 6}, {-1, 5}, {0.2, 3.5}, {1, 2.8}, {2, 2.5}, {3, 2}, {-3, 1.5} },
+  // (2, 4), (6, 6) and (8, 7) are collinear
+  { {6, 6}, {8, 7}, {7, 8}, {10, 10}, {10, 0}, {0, 0}, {8, 1}, {8, 3},
+    {6, 3}, {4, 4}, {2, 4} }
 };
 
 TEST_P(MonotonesTriangulationTest, TriangulateMonotone) {
   geom::Polygon2D polygon(GetParam());
-  answer_ = geom::TriangulateYMonotone(polygon);
+  for (const geom::VertexTriangle& vertices :
+       geom::TriangulateYMonotone(polygon)) {
+    const geom::Triangle2D triangle = polygon.Triangle(vertices);
+    EXPECT_LT(geom::Orient2D(triangle.a, triangle.b, triangle.c), 0);
+    answer_.push_back(geom::Polygon2D({triangle.a, triangle.b, triangle.c}));
+  }
 }
 
 INSTANTIATE_TEST_SUITE_P(Decomposition,
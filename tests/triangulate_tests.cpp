@@ -5,6 +5,17 @@
 #include <test_utils/decomposition_utils.h>
 #include <test_utils/triangulate_utils.h>
 
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <memory_resource>
+#include <random>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 namespace decomposition_tests {
@@ -16,8 +27,652 @@ TEST_P(TriangulationTest, Triangulate) {
   }
 }
 
+TEST_P(TriangulationTest, TriangulateIndexed) {
+  geom::IndexedTriangles2D triangles;
+  geom::Triangulate(GetParam(), &triangles);
+  ASSERT_TRUE(PolygonVectorEqual(
+      GetParam(), {triangles.points.begin(),
+                   triangles.points.begin() + GetParam().size()}));
+  ASSERT_EQ(triangles.indices.size() % 3, 0);
+  for (size_t i = 0; i < triangles.indices.size(); i += 3) {
+    answer_.push_back(geom::Polygon2D({
+        triangles.points[triangles.indices[i]],
+        triangles.points[triangles.indices[i + 1]],
+        triangles.points[triangles.indices[i + 2]]}));
+  }
+}
+
 INSTANTIATE_TEST_SUITE_P(Decomposition,
                          TriangulationTest,
                          testing::ValuesIn(test_polygons));
 
+TEST(IndexedTriangulationTest, IntersectionPointsAppended) {
+  for (const std::vector<geom::Point2D>& polygon_v :
+       self_intersecting_polygons) {
+    const std::vector<geom::Triangle2D> expected = geom::Triangulate(polygon_v);
+    geom::IndexedTriangles2D triangles;
+    geom::Triangulate(polygon_v, &triangles);
+    ASSERT_EQ(triangles.indices.size(), 3 * expected.size());
+    EXPECT_EQ(triangles.points.size(), polygon_v.size() + 1);
+    EXPECT_TRUE(geom::DoubleEqual(triangles.points.back(), {0, 0}));
+    for (size_t i = 0; i < expected.size(); i++) {
+      EXPECT_TRUE(geom::DoubleEqual(
+          triangles.points[triangles.indices[3 * i]], expected[i].a));
+      EXPECT_TRUE(geom::DoubleEqual(
+          triangles.points[triangles.indices[3 * i + 1]], expected[i].b));
+      EXPECT_TRUE(geom::DoubleEqual(
+          triangles.points[triangles.indices[3 * i + 2]], expected[i].c));
+    }
+  }
+}
+
+template<class T>
+class CoordinateTypeTest : public testing::Test {
+ protected:
+  static T Narrow(double value) {
+    if constexpr (std::is_integral_v<T>)
+      return static_cast<T>(std::lround(value));
+    else
+      return static_cast<T>(value);
+  }
+
+  static std::vector<geom::BasicPoint2D<T> > Narrow(
+      const std::vector<geom::Point2D>& polygon_v) {
+    std::vector<geom::BasicPoint2D<T> > res;
+    for (const geom::Point2D& point : polygon_v)
+      res.push_back({Narrow(point.x), Narrow(point.y)});
+    return res;
+  }
+
+  static std::vector<geom::Point2D> Widen(
+      const std::vector<geom::BasicPoint2D<T> >& polygon_v) {
+    std::vector<geom::Point2D> res;
+    for (const geom::BasicPoint2D<T>& point : polygon_v)
+      res.push_back({static_cast<double>(point.x),
+                     static_cast<double>(point.y)});
+    return res;
+  }
+
+  static void ExpectEqual(const geom::BasicPoint2D<T>& actual,
+                          const geom::Point2D& expected) {
+    EXPECT_EQ(actual.x, Narrow(expected.x));
+    EXPECT_EQ(actual.y, Narrow(expected.y));
+  }
+
+  static void ExpectEqual(
+      const std::vector<geom::BasicTriangle2D<T> >& actual,
+      const std::vector<geom::Triangle2D>& expected) {
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      ExpectEqual(actual[i].a, expected[i].a);
+      ExpectEqual(actual[i].b, expected[i].b);
+      ExpectEqual(actual[i].c, expected[i].c);
+    }
+  }
+};
+
+using CoordinateTypes = testing::Types<float, int32_t>;
+TYPED_TEST_SUITE(CoordinateTypeTest, CoordinateTypes);
+
+// Same triangles as of the input widened to double by the caller
+TYPED_TEST(CoordinateTypeTest, SameAsWidenedToDouble) {
+  std::vector<std::vector<geom::Point2D> > polygons(
+      std::begin(test_polygons), std::end(test_polygons));
+  polygons.insert(polygons.end(), std::begin(self_intersecting_polygons),
+                  std::end(self_intersecting_polygons));
+  for (const std::vector<geom::Point2D>& polygon_v : polygons) {
+    const std::vector<geom::BasicPoint2D<TypeParam> > narrow_v =
+        this->Narrow(polygon_v);
+    const std::vector<geom::Triangle2D> expected =
+        geom::Triangulate(this->Widen(narrow_v));
+    this->ExpectEqual(geom::Triangulate(narrow_v), expected);
+
+    geom::BasicIndexedTriangles2D<TypeParam> indexed;
+    geom::Triangulate(narrow_v, &indexed);
+    ASSERT_EQ(indexed.indices.size(), 3 * expected.size());
+    for (size_t i = 0; i < narrow_v.size(); i++) {
+      EXPECT_EQ(indexed.points[i].x, narrow_v[i].x);
+      EXPECT_EQ(indexed.points[i].y, narrow_v[i].y);
+    }
+    for (size_t i = 0; i < expected.size(); i++) {
+      this->ExpectEqual(indexed.points[indexed.indices[3 * i]],
+                        expected[i].a);
+      this->ExpectEqual(indexed.points[indexed.indices[3 * i + 1]],
+                        expected[i].b);
+      this->ExpectEqual(indexed.points[indexed.indices[3 * i + 2]],
+                        expected[i].c);
+    }
+  }
+
+  const std::vector<geom::BasicPoint2D<TypeParam> > polygon_v =
+      this->Narrow(polygon_with_holes[0]);
+  std::vector<std::vector<geom::BasicPoint2D<TypeParam> > > holes_v;
+  std::vector<std::vector<geom::Point2D> > wide_holes_v;
+  for (size_t i = 1; i < std::size(polygon_with_holes); i++) {
+    holes_v.push_back(this->Narrow(polygon_with_holes[i]));
+    wide_holes_v.push_back(this->Widen(holes_v.back()));
+  }
+  this->ExpectEqual(
+      geom::TriangulateWithHoles(polygon_v, holes_v),
+      geom::TriangulateWithHoles(this->Widen(polygon_v), wide_holes_v));
+}
+
+namespace {
+
+class CountingMemoryResource : public std::pmr::memory_resource {
+ public:
+  size_t allocations = 0;
+
+ private:
+  void* do_allocate(size_t bytes, size_t alignment) override {
+    allocations++;
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+  }
+
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+    std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override {
+    return this == &other;
+  }
+};
+
+}  // namespace
+
+TEST(TriangulationContextTest, NoAllocationsInSteadyState) {
+  CountingMemoryResource upstream;
+  geom::TriangulationContext context(&upstream);
+  geom::TriangulationOptions options;
+  options.context = &context;
+  std::vector<std::vector<geom::Point2D> > polygons(
+      std::begin(test_polygons), std::end(test_polygons));
+  polygons.insert(polygons.end(), std::begin(self_intersecting_polygons),
+                  std::end(self_intersecting_polygons));
+  for (const std::vector<geom::Point2D>& polygon_v : polygons) {
+    geom::IndexedTriangles2D expected;
+    geom::Triangulate(polygon_v, &expected);
+
+    geom::IndexedTriangles2D triangles;
+    geom::Triangulate(polygon_v, options, &triangles);
+    const size_t allocations = upstream.allocations;
+    EXPECT_GT(allocations, 0);
+    geom::Triangulate(polygon_v, options, &triangles);
+    EXPECT_EQ(upstream.allocations, allocations);
+    EXPECT_EQ(triangles.indices, expected.indices);
+  }
+}
+
+TEST(TriangulationHintsTest, SameTrianglesCount) {
+  std::vector<geom::Point2D> arc;
+  for (size_t i = 0; i < 100; i++) {
+    const double angle = M_PI_2 * i / 100;
+    arc.push_back({1e3 * std::cos(angle), 1e3 * std::sin(angle)});
+  }
+  const std::vector<geom::Point2D> reversed_arc(arc.rbegin(), arc.rend());
+
+  geom::TriangulationOptions options;
+  options.known_convex = true;
+  options.known_orientation = geom::TriangulationOptions::COUNTERCLOCKWISE;
+  const std::vector<geom::Triangle2D> hinted =
+      geom::Triangulate(arc, options);
+  EXPECT_EQ(hinted.size(), geom::Triangulate(arc).size());
+  EXPECT_EQ(hinted.size(), arc.size() - 2);
+
+  // Same triangles since the polygon is the same ring
+  options.known_orientation = geom::TriangulationOptions::CLOCKWISE;
+  const std::vector<geom::Triangle2D> hinted_reversed =
+      geom::Triangulate(reversed_arc, options);
+  ASSERT_EQ(hinted_reversed.size(), hinted.size());
+
+  options = geom::TriangulationOptions();
+  options.known_simple = true;
+  for (const std::vector<geom::Point2D>& polygon_v : test_polygons)
+    EXPECT_EQ(geom::Triangulate(polygon_v, options).size(),
+              geom::Triangulate(polygon_v).size());
+}
+
+TEST(TriangulationStatsTest, CountersMatchResult) {
+  for (const std::vector<geom::Point2D>& polygon_v :
+       self_intersecting_polygons) {
+    geom::TriangulationStats stats;
+    geom::TriangulationOptions options;
+    options.stats = &stats;
+    options.engine = geom::TriangulationOptions::MONOTONE_ENGINE;
+    const std::vector<geom::Triangle2D> triangles =
+        geom::Triangulate(polygon_v, options);
+
+    EXPECT_EQ(stats.triangles, triangles.size());
+    EXPECT_EQ(stats.ear_clipped_pieces, 0);
+    EXPECT_GT(stats.intersections, 0);
+    EXPECT_GE(stats.events, 2 * polygon_v.size());
+    EXPECT_GE(stats.monotone_pieces, 1);
+    EXPECT_GE(stats.inserted_edges + stats.monotone_pieces,
+              stats.triangles);
+
+    // Same pieces are processed in parallel mode
+    geom::TriangulationStats parallel_stats;
+    options.stats = &parallel_stats;
+    options.num_threads = 3;
+    geom::Triangulate(polygon_v, options);
+    EXPECT_EQ(parallel_stats.intersections, stats.intersections);
+    EXPECT_EQ(parallel_stats.events, stats.events);
+    EXPECT_EQ(parallel_stats.inserted_edges, stats.inserted_edges);
+    EXPECT_EQ(parallel_stats.monotone_pieces, stats.monotone_pieces);
+    EXPECT_EQ(parallel_stats.triangles, stats.triangles);
+
+    // Small pieces are ear clipped by default
+    geom::TriangulationStats auto_stats;
+    options = geom::TriangulationOptions();
+    options.stats = &auto_stats;
+    EXPECT_EQ(geom::Triangulate(polygon_v, options).size(), triangles.size());
+    EXPECT_EQ(auto_stats.intersections, stats.intersections);
+    EXPECT_GE(auto_stats.ear_clipped_pieces, 1);
+    EXPECT_EQ(auto_stats.monotone_pieces, 0);
+    EXPECT_EQ(auto_stats.triangles, stats.triangles);
+    EXPECT_GT(auto_stats.ear_clipping_time.count(), 0);
+
+    // Ear clipping is timed apart from decomposition in parallel mode too
+    geom::TriangulationStats parallel_auto_stats;
+    options.stats = &parallel_auto_stats;
+    options.num_threads = 3;
+    geom::Triangulate(polygon_v, options);
+    EXPECT_EQ(parallel_auto_stats.ear_clipped_pieces,
+              auto_stats.ear_clipped_pieces);
+    EXPECT_GT(parallel_auto_stats.ear_clipping_time.count(), 0);
+    EXPECT_EQ(parallel_auto_stats.triangles, stats.triangles);
+  }
+}
+
+// Sum of absolute areas, the same for any triangulation of a polygon
+double TrianglesArea(const std::vector<geom::Triangle2D>& triangles) {
+  double area = 0;
+  for (const geom::Triangle2D& triangle : triangles)
+    area += std::abs((triangle.b.x - triangle.a.x) *
+                         (triangle.c.y - triangle.a.y) -
+                     (triangle.b.y - triangle.a.y) *
+                         (triangle.c.x - triangle.a.x)) / 2;
+  return area;
+}
+
+TEST(TriangulationWithHolesTest, AreaAndTrianglesCount) {
+  const std::vector<geom::Point2D>& polygon_v = polygon_with_holes[0];
+  const std::vector<std::vector<geom::Point2D> > holes_v(
+      std::begin(polygon_with_holes) + 1, std::end(polygon_with_holes));
+  size_t size = polygon_v.size();
+  for (const std::vector<geom::Point2D>& hole_v : holes_v)
+    size += hole_v.size();
+
+  geom::TriangulationOptions options;
+  for (auto engine : {geom::TriangulationOptions::AUTO_ENGINE,
+                      geom::TriangulationOptions::MONOTONE_ENGINE,
+                      geom::TriangulationOptions::EAR_CLIPPING_ENGINE}) {
+    for (size_t num_threads : {1, 3}) {
+      options.engine = engine;
+      options.num_threads = num_threads;
+      const std::vector<geom::Triangle2D> triangles =
+          geom::TriangulateWithHoles(polygon_v, holes_v, options);
+      EXPECT_EQ(triangles.size(), size + 2 * holes_v.size() - 2);
+      EXPECT_NEAR(TrianglesArea(triangles), polygon_with_holes_area, 1e-9);
+    }
+  }
+
+  // Holes of any orientation, no bridge vertices are added
+  std::vector<std::vector<geom::Point2D> > reversed_holes_v;
+  for (const std::vector<geom::Point2D>& hole_v : holes_v)
+    reversed_holes_v.emplace_back(hole_v.rbegin(), hole_v.rend());
+  geom::IndexedTriangles2D triangles;
+  geom::TriangulateWithHoles(polygon_v, reversed_holes_v,
+                             geom::TriangulationOptions(), &triangles);
+  EXPECT_EQ(triangles.points.size(), size);
+  EXPECT_EQ(triangles.indices.size(), 3 * (size + 2 * holes_v.size() - 2));
+
+  // Points of skipped degenerate holes keep their indices too
+  reversed_holes_v.insert(reversed_holes_v.begin(), {{1, 1}, {1, 1}});
+  const std::vector<geom::Triangle2D> expected =
+      geom::TriangulateWithHoles(polygon_v, reversed_holes_v);
+  geom::TriangulateWithHoles(polygon_v, reversed_holes_v,
+                             geom::TriangulationOptions(), &triangles);
+  EXPECT_EQ(triangles.points.size(), size + 2);
+  ASSERT_EQ(triangles.indices.size(), 3 * expected.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_TRUE(geom::DoubleEqual(
+        triangles.points[triangles.indices[3 * i]], expected[i].a));
+    EXPECT_TRUE(geom::DoubleEqual(
+        triangles.points[triangles.indices[3 * i + 1]], expected[i].b));
+    EXPECT_TRUE(geom::DoubleEqual(
+        triangles.points[triangles.indices[3 * i + 2]], expected[i].c));
+  }
+
+  EXPECT_EQ(geom::TriangulateWithHoles(polygon_v, {}).size(),
+            geom::Triangulate(polygon_v).size());
+}
+
+TEST(TriangulationWithHolesTest, InvalidHolesRejected) {
+  const std::vector<geom::Point2D>& polygon_v = polygon_with_holes[0];
+  std::vector<std::vector<geom::Point2D> > holes_v(
+      std::begin(polygon_with_holes) + 1, std::end(polygon_with_holes));
+  std::string error;
+  EXPECT_TRUE(geom::IsValidPolygonWithHoles(polygon_v, holes_v, &error));
+  EXPECT_TRUE(error.empty());
+  // Without holes self-intersections are resolved
+  EXPECT_TRUE(geom::IsValidPolygonWithHoles(self_intersecting_polygons[0],
+                                            {}));
+
+  // Degenerate holes are skipped, but still counted in the message
+  holes_v.insert(holes_v.begin(), {{1, 1}, {1, 1}});
+  holes_v.push_back({{8, 5}, {11, 6}, {8, 7}});
+  EXPECT_FALSE(geom::IsValidPolygonWithHoles(polygon_v, holes_v, &error));
+  EXPECT_EQ(error.rfind("rings cross or touch at", 0), 0);
+  holes_v.back() = {{11, 1}, {12, 1}, {12, 2}};
+  EXPECT_FALSE(geom::IsValidPolygonWithHoles(polygon_v, holes_v, &error));
+  EXPECT_EQ(error, "hole 4 is outside the polygon or inside another hole");
+
+  const std::vector<geom::Point2D> flat = {{0, 0}, {1, 1}, {2, 2}};
+  EXPECT_FALSE(geom::IsValidPolygonWithHoles(flat, {{{1, 0}, {2, 0},
+                                                     {2, 1}}}));
+}
+
+TEST(TriangulationEngineTest, SameAreaAsMonotone) {
+  std::vector<std::vector<geom::Point2D> > polygons(
+      std::begin(test_polygons), std::end(test_polygons));
+  polygons.insert(polygons.end(), std::begin(self_intersecting_polygons),
+                  std::end(self_intersecting_polygons));
+  // Jagged star with plenty of reflex vertices, both below and above
+  // the default threshold
+  for (size_t size : {12, 30, 200}) {
+    std::vector<geom::Point2D> star;
+    for (size_t i = 0; i < size; i++) {
+      const double distance = i % 2 ? 1e3 : 3e2 + 1e2 * (i % 5);
+      const double angle = 2 * M_PI * i / size;
+      star.push_back({distance * std::cos(angle), distance * std::sin(angle)});
+    }
+    polygons.push_back(star);
+  }
+
+  for (const std::vector<geom::Point2D>& polygon_v : polygons) {
+    geom::TriangulationOptions options;
+    options.engine = geom::TriangulationOptions::MONOTONE_ENGINE;
+    const std::vector<geom::Triangle2D> expected =
+        geom::Triangulate(polygon_v, options);
+
+    for (auto engine : {geom::TriangulationOptions::AUTO_ENGINE,
+                        geom::TriangulationOptions::EAR_CLIPPING_ENGINE}) {
+      for (size_t num_threads : {1, 3}) {
+        options.engine = engine;
+        options.num_threads = num_threads;
+        const std::vector<geom::Triangle2D> triangles =
+            geom::Triangulate(polygon_v, options);
+        EXPECT_EQ(triangles.size(), expected.size());
+        EXPECT_NEAR(TrianglesArea(triangles), TrianglesArea(expected),
+                    1e-9 * TrianglesArea(expected));
+      }
+    }
+  }
+}
+
+TEST(ParallelTriangulationTest, SameAsSequential) {
+  std::vector<std::vector<geom::Point2D> > polygons(
+      std::begin(test_polygons), std::end(test_polygons));
+  for (size_t i = 0; i < 20; i++) {
+    std::vector<geom::Point2D> random_polygon_v;
+    for (size_t j = 0; j < 10 + 5 * i; j++)
+      random_polygon_v.push_back({DoubleRand(0, 100), DoubleRand(0, 100)});
+    polygons.push_back(random_polygon_v);
+  }
+
+  geom::TriangulationOptions options;
+  options.num_threads = 4;
+  for (const std::vector<geom::Point2D>& polygon_v : polygons) {
+    const std::vector<geom::Triangle2D> expected =
+        geom::Triangulate(polygon_v);
+    const std::vector<geom::Triangle2D> actual =
+        geom::Triangulate(polygon_v, options);
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t j = 0; j < expected.size(); j++) {
+      EXPECT_TRUE(geom::DoubleEqual(actual[j].a, expected[j].a));
+      EXPECT_TRUE(geom::DoubleEqual(actual[j].b, expected[j].b));
+      EXPECT_TRUE(geom::DoubleEqual(actual[j].c, expected[j].c));
+    }
+  }
+}
+
+TEST(BatchTriangulationTest, SameAsSequential) {
+  std::vector<std::vector<geom::Point2D> > polygons;
+  for (size_t i = 0; i < 20; i++) {
+    for (const std::vector<geom::Point2D>& polygon_v : test_polygons)
+      polygons.push_back(polygon_v);
+    for (const std::vector<geom::Point2D>& polygon_v :
+         self_intersecting_polygons)
+      polygons.push_back(polygon_v);
+    std::vector<geom::Point2D> random_polygon_v;
+    for (size_t j = 0; j < 3 + 5 * i; j++)
+      random_polygon_v.push_back({DoubleRand(0, 100), DoubleRand(0, 100)});
+    polygons.push_back(random_polygon_v);
+  }
+
+  for (size_t num_threads : {1, 3, 8}) {
+    const std::vector<std::vector<geom::Triangle2D> > batch =
+        geom::TriangulateBatch(polygons, num_threads);
+    ASSERT_EQ(batch.size(), polygons.size());
+    for (size_t i = 0; i < polygons.size(); i++) {
+      const std::vector<geom::Triangle2D> expected =
+          geom::Triangulate(polygons[i]);
+      ASSERT_EQ(batch[i].size(), expected.size());
+      for (size_t j = 0; j < expected.size(); j++) {
+        EXPECT_TRUE(geom::DoubleEqual(batch[i][j].a, expected[j].a));
+        EXPECT_TRUE(geom::DoubleEqual(batch[i][j].b, expected[j].b));
+        EXPECT_TRUE(geom::DoubleEqual(batch[i][j].c, expected[j].c));
+      }
+    }
+  }
+}
+
+TEST(BatchTriangulationTest, IndexedWithOptions) {
+  std::vector<std::vector<geom::Point2D> > polygons(
+      std::begin(test_polygons), std::end(test_polygons));
+  polygons.insert(polygons.end(), std::begin(self_intersecting_polygons),
+                  std::end(self_intersecting_polygons));
+
+  geom::TriangulationOptions options;
+  options.engine = geom::TriangulationOptions::MONOTONE_ENGINE;
+  for (size_t num_threads : {1, 3}) {
+    options.num_threads = num_threads;
+    geom::TriangulationStats stats;
+    options.stats = &stats;
+    std::vector<geom::IndexedTriangles2D> results;
+    geom::TriangulateBatch(polygons, options, &results);
+    ASSERT_EQ(results.size(), polygons.size());
+    size_t triangles = 0;
+    for (size_t i = 0; i < polygons.size(); i++) {
+      geom::TriangulationOptions polygon_options;
+      polygon_options.engine = options.engine;
+      geom::IndexedTriangles2D expected;
+      geom::Triangulate(polygons[i], polygon_options, &expected);
+      EXPECT_EQ(results[i].indices, expected.indices);
+      EXPECT_EQ(results[i].points.size(), expected.points.size());
+      triangles += expected.indices.size() / 3;
+    }
+    EXPECT_EQ(stats.triangles, triangles);
+    EXPECT_EQ(stats.ear_clipped_pieces, 0);
+  }
+}
+
+TEST(BatchTriangulationTest, WithHoles) {
+  geom::PolygonWithHoles2D polygon;
+  polygon.ring = polygon_with_holes[0];
+  polygon.holes.assign(std::begin(polygon_with_holes) + 1,
+                       std::end(polygon_with_holes));
+  geom::PolygonWithHoles2D invalid_polygon = polygon;
+  invalid_polygon.holes.push_back({{8, 5}, {11, 6}, {8, 7}});
+  geom::PolygonWithHoles2D self_intersecting_polygon;
+  self_intersecting_polygon.ring = self_intersecting_polygons[0];
+  const std::vector<geom::PolygonWithHoles2D> polygons = {
+      polygon, invalid_polygon, self_intersecting_polygon};
+
+  geom::TriangulationOptions options;
+  options.num_threads = 2;
+  std::vector<geom::IndexedTriangles2D> results;
+  std::vector<std::string> errors;
+  geom::TriangulateBatch(polygons, options, &results, &errors);
+  ASSERT_EQ(results.size(), 3);
+  ASSERT_EQ(errors.size(), 3);
+
+  geom::IndexedTriangles2D expected;
+  geom::TriangulateWithHoles(polygon.ring, polygon.holes,
+                             geom::TriangulationOptions(), &expected);
+  EXPECT_EQ(results[0].indices, expected.indices);
+  EXPECT_TRUE(errors[0].empty());
+  EXPECT_TRUE(results[1].indices.empty());
+  EXPECT_FALSE(errors[1].empty());
+  geom::Triangulate(self_intersecting_polygon.ring, &expected);
+  EXPECT_EQ(results[2].indices, expected.indices);
+  EXPECT_EQ(results[2].points.size(), expected.points.size());
+  EXPECT_TRUE(errors[2].empty());
+}
+
+TEST(ConcurrentTriangulationTest, SameAsSequential) {
+  std::vector<std::vector<geom::Point2D> > polygons(
+      std::begin(self_intersecting_polygons),
+      std::end(self_intersecting_polygons));
+  for (size_t i = 0; i < 10; i++) {
+    std::vector<geom::Point2D> random_polygon_v;
+    for (size_t j = 0; j < 10 + 3 * i; j++)
+      random_polygon_v.push_back({DoubleRand(0, 100), DoubleRand(0, 100)});
+    polygons.push_back(random_polygon_v);
+  }
+  std::vector<std::vector<geom::Triangle2D> > expected;
+  for (const std::vector<geom::Point2D>& polygon_v : polygons)
+    expected.push_back(geom::Triangulate(polygon_v));
+
+  // Plain std::threads so sweeps really interleave with each other
+  const size_t threads_count = 4, repeats = 3;
+  std::vector<std::vector<std::vector<geom::Triangle2D> > > actual(
+      threads_count);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < threads_count; t++) {
+    threads.emplace_back([&polygons, &actual, t]() {
+      geom::TriangulationContext context;
+      geom::TriangulationOptions options;
+      if (t % 2)
+        options.context = &context;
+      for (size_t r = 0; r < repeats; r++) {
+        actual[t].clear();
+        for (const std::vector<geom::Point2D>& polygon_v : polygons)
+          actual[t].push_back(geom::Triangulate(polygon_v, options));
+      }
+    });
+  }
+  for (std::thread& thread : threads)
+    thread.join();
+
+  for (size_t t = 0; t < threads_count; t++) {
+    ASSERT_EQ(actual[t].size(), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+      ASSERT_EQ(actual[t][i].size(), expected[i].size());
+      for (size_t j = 0; j < expected[i].size(); j++) {
+        EXPECT_TRUE(geom::DoubleEqual(actual[t][i][j].a, expected[i][j].a));
+        EXPECT_TRUE(geom::DoubleEqual(actual[t][i][j].b, expected[i][j].b));
+        EXPECT_TRUE(geom::DoubleEqual(actual[t][i][j].c, expected[i][j].c));
+      }
+    }
+  }
+}
+
+namespace {
+
+// Fresh directory per test, so parallel runs and files left
+// by a crashed run don't collide, removed with everything in it
+class TempDirectory {
+ public:
+  TempDirectory() {
+    const std::string test_name =
+        testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::random_device random;
+    do {
+      path_ = std::filesystem::temp_directory_path() /
+              (test_name + "_" + std::to_string(random()));
+    } while (!std::filesystem::create_directory(path_));
+  }
+
+  ~TempDirectory() {
+    std::error_code error;
+    std::filesystem::remove_all(path_, error);
+  }
+
+  TempDirectory(const TempDirectory&) = delete;
+  TempDirectory& operator=(const TempDirectory&) = delete;
+
+  std::string File(const std::string& name) const {
+    return (path_ / name).string();
+  }
+
+ private:
+  std::filesystem::path path_;
+};
+
+}  // namespace
+
+TEST(StreamingTriangulationTest, SameAsInMemory) {
+  std::vector<std::vector<geom::Point2D> > polygons(
+      std::begin(self_intersecting_polygons),
+      std::end(self_intersecting_polygons));
+  std::vector<geom::Point2D> random_polygon_v;
+  for (size_t j = 0; j < 100; j++)
+    random_polygon_v.push_back({DoubleRand(0, 100), DoubleRand(0, 100)});
+  polygons.push_back(random_polygon_v);
+
+  const TempDirectory directory;
+  const std::string polygon_path = directory.File("polygon.bin");
+  const std::string triangles_path = directory.File("triangles.bin");
+  for (const std::vector<geom::Point2D>& polygon_v : polygons) {
+    const std::vector<geom::Triangle2D> expected =
+        geom::Triangulate(polygon_v);
+
+    std::vector<geom::Triangle2D> streamed;
+    geom::Triangulate<double>(polygon_v.data(),
+                              polygon_v.data() + polygon_v.size(),
+                              geom::TriangulationOptions(),
+                              [&](const geom::Triangle2D& triangle) {
+      streamed.push_back(triangle);
+    });
+
+    {
+      std::ofstream polygon_file(polygon_path, std::ios::binary);
+      polygon_file.write(reinterpret_cast<const char*>(polygon_v.data()),
+                         polygon_v.size() * sizeof(geom::Point2D));
+    }
+    ASSERT_TRUE(geom::TriangulateFile(polygon_path, triangles_path));
+    std::vector<geom::Triangle2D> from_file(
+        std::filesystem::file_size(triangles_path) / sizeof(geom::Triangle2D));
+    std::ifstream triangles_file(triangles_path, std::ios::binary);
+    triangles_file.read(reinterpret_cast<char*>(from_file.data()),
+                        from_file.size() * sizeof(geom::Triangle2D));
+
+    for (const std::vector<geom::Triangle2D>* actual :
+         {&streamed, &from_file}) {
+      ASSERT_EQ(actual->size(), expected.size());
+      for (size_t j = 0; j < expected.size(); j++) {
+        EXPECT_TRUE(geom::DoubleEqual((*actual)[j].a, expected[j].a));
+        EXPECT_TRUE(geom::DoubleEqual((*actual)[j].b, expected[j].b));
+        EXPECT_TRUE(geom::DoubleEqual((*actual)[j].c, expected[j].c));
+      }
+    }
+  }
+  // Triangles file can't be created
+  EXPECT_FALSE(geom::TriangulateFile(
+      polygon_path, directory.File("missing/triangles.bin")));
+
+  // Not a whole number of points
+  {
+    std::ofstream polygon_file(polygon_path, std::ios::binary);
+    polygon_file.write("\0\0\0", 3);
+  }
+  EXPECT_FALSE(geom::TriangulateFile(polygon_path, triangles_path));
+  std::filesystem::remove(polygon_path);
+  std::filesystem::remove(triangles_path);
+  EXPECT_FALSE(geom::TriangulateFile(polygon_path, triangles_path));
+}
+
 }  // decomposition_tests
@@ -2,10 +2,21 @@
 
 #include <dcel_polygon2d.h>
 #include <geom_utils.h>
+#include <parallel_for.h>
 #include <polygon2d.h>
+#include <polygon_shape.h>
+#include <segments_on_y_sweep_line.h>
+#include <sweep_order.h>
 #include <test_utils/decomposition_utils.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
 #include <optional>
+#include <random>
+#include <stdexcept>
+#include <vector>
 
 namespace decomposition_tests {
 
@@ -18,6 +29,40 @@ TEST_P(SimpleDecompositionTest, DecompositionWithDcel) {
     answer_.push_back(geom::AsVector(res_polygon));
 }
 
+TEST(Polygon2DTest, CopyKeepsVertices) {
+  for (const std::vector<geom::Point2D>& polygon_v : test_polygons) {
+    std::optional<geom::Polygon2D> original(std::in_place, polygon_v);
+    const geom::Polygon2D copy = original.value();
+    original.reset();
+    const geom::Polygon2D expected(polygon_v);
+    EXPECT_TRUE(PolygonVectorEqual(geom::AsVector(copy),
+                                   geom::AsVector(expected)));
+    for (size_t i = 0; i < copy.Size(); i++) {
+      EXPECT_EQ(copy.Prev(copy.Next(i)), i);
+      EXPECT_EQ(copy.Type(i), expected.Type(i));
+    }
+  }
+}
+
+TEST(Polygon2DTest, RingsAreClockwise) {
+  // Counterclockwise square with a repeated vertex
+  const std::vector<geom::Point2D> square = {
+      {0, 0}, {2, 0}, {2, 0}, {2, 2}, {0, 2}};
+  const geom::Polygon2D polygon(square);
+  ASSERT_EQ(polygon.Size(), 4);
+  EXPECT_EQ(polygon.Point(0), square[0]);
+  EXPECT_EQ(polygon.Point(1), square[4]);
+  EXPECT_EQ(polygon.Point(3), square[1]);
+  EXPECT_EQ(polygon.Type(1), geom::Polygon2D::START);
+  EXPECT_EQ(polygon.Type(polygon.Prev(0)), geom::Polygon2D::END);
+
+  const geom::Polygon2D hole = geom::Polygon2D::HoleFromRing(
+      square.data(), square.data() + square.size());
+  EXPECT_EQ(hole.Point(1), square[1]);
+  EXPECT_EQ(hole.Type(3), geom::Polygon2D::SPLIT);
+  EXPECT_EQ(hole.Type(1), geom::Polygon2D::MERGE);
+}
+
 namespace {
 
 geom::Point2D operator*(const geom::Point2D& point, double matrix[2][2]) {
@@ -120,6 +165,287 @@ INSTANTIATE_TEST_SUITE_P(GeomUtils,
                          IntercestionTest,
                          testing::ValuesIn(segment_intersection_cases));
 
+TEST(ParallelForTest, EveryIndexOnce) {
+  for (size_t n : {0, 1, 7, 1000}) {
+    for (size_t num_threads : {0, 1, 2, 5, 16}) {
+      std::vector<std::atomic<int> > visits(n);
+      geom::ParallelFor(n, num_threads, [&](size_t i) { visits[i]++; });
+      for (size_t i = 0; i < n; i++)
+        EXPECT_EQ(visits[i].load(), 1);
+    }
+  }
+}
+
+TEST(ParallelForTest, ThreadIndices) {
+  constexpr size_t kThreads = 4;
+  // Counters of a thread are touched by that thread only
+  std::vector<size_t> counts(kThreads, 0);
+  geom::ParallelFor(1000, kThreads, [&](size_t, size_t thread) {
+    ASSERT_LT(thread, kThreads);
+    counts[thread]++;
+  });
+  size_t total = 0;
+  for (size_t count : counts)
+    total += count;
+  EXPECT_EQ(total, 1000);
+
+  geom::ParallelFor(2, 0, [](size_t, size_t thread) {
+    EXPECT_LT(thread, 2);
+  });
+}
+
+TEST(ParallelForTest, NestedAndThrowing) {
+  std::vector<std::atomic<int> > visits(64);
+  geom::ParallelFor(8, 4, [&](size_t i) {
+    geom::ParallelFor(8, 4, [&](size_t j) { visits[i * 8 + j]++; });
+  });
+  for (const std::atomic<int>& visit : visits)
+    EXPECT_EQ(visit.load(), 1);
+
+  EXPECT_THROW(geom::ParallelFor(100, 4, [](size_t i) {
+    if (i == 42)
+      throw std::runtime_error("task failed");
+  }), std::runtime_error);
+  // Pool is still usable after a failed call
+  std::atomic<size_t> sum(0);
+  geom::ParallelFor(100, 4, [&](size_t i) { sum += i; });
+  EXPECT_EQ(sum.load(), 4950);
+}
+
+TEST(SweepOrderTest, MatchesComparator) {
+  std::mt19937 random(11);
+  std::uniform_real_distribution<double> coordinate(-1e3, 1e3);
+  // Grid gives repeated points, its zero comes with both signs
+  std::uniform_int_distribution<int> grid(-2, 2);
+  std::uniform_int_distribution<int> type(geom::Polygon2D::START,
+                                          geom::Polygon2D::RIGHT_REGULAR);
+  for (size_t size : {0, 1, 10, 511, 512, 3000}) {
+    for (bool on_grid : {false, true}) {
+      std::vector<double> x(size), y(size);
+      std::vector<geom::Polygon2D::VertexType> types(size);
+      for (size_t i = 0; i < size; i++) {
+        x[i] = on_grid ? grid(random) * (i % 2 ? -1.0 : 1.0)
+                       : coordinate(random);
+        y[i] = on_grid ? grid(random) * (i % 3 ? -1.0 : 1.0)
+                       : coordinate(random);
+        types[i] = geom::Polygon2D::VertexType(type(random));
+      }
+      std::vector<uint32_t> expected(size);
+      std::iota(expected.begin(), expected.end(), 0);
+      std::sort(expected.rbegin(), expected.rend(),
+                geom::YFirstVertexComparator(x.data(), y.data(),
+                                             types.data()));
+      const std::pmr::vector<uint32_t> order =
+          geom::SweepOrder(x.data(), y.data(), types.data(), size);
+      EXPECT_TRUE(std::equal(order.begin(), order.end(), expected.begin(),
+                             expected.end()))
+          << "size " << size << " on grid " << on_grid;
+    }
+  }
+}
+
+TEST(PolarAngleTest, OrderMatchesAtan2) {
+  std::vector<geom::Vector2D> vectors;
+  for (double x = -2; x <= 2; x++)
+    for (double y = -2; y <= 2; y++)
+      if (x != 0 || y != 0)
+        vectors.push_back({x, y});
+  for (const geom::Vector2D& v : vectors)
+    for (const geom::Vector2D& u : vectors) {
+      const double v_angle = v.y == 0 && v.x < 0 ? -M_PI : std::atan2(v.y, v.x);
+      const double u_angle = u.y == 0 && u.x < 0 ? -M_PI : std::atan2(u.y, u.x);
+      if (geom::DoubleEqual(v_angle, u_angle))
+        EXPECT_FALSE(geom::PolarAngleLess(v, u));
+      else
+        EXPECT_EQ(geom::PolarAngleLess(v, u), v_angle < u_angle);
+    }
+}
+
+TEST(PolarAngleTest, NearlyCollinear) {
+  const geom::Vector2D v = {1e6, 1};
+  const geom::Vector2D u = {1e6, 1 + 1e-9};
+  EXPECT_TRUE(geom::PolarAngleLess(v, u));
+  EXPECT_FALSE(geom::PolarAngleLess(u, v));
+  EXPECT_FALSE(geom::PolarAngleLess(v, {2e6, 2}));
+  EXPECT_FALSE(geom::PolarAngleLess({2e6, 2}, v));
+}
+
+TEST(Orient2DTest, NearlyCollinear) {
+  // Naive cross product gets wrong signs on this grid of points
+  // a few ulps away from the line y = x
+  const double ulp = std::ldexp(1, -53);
+  const geom::Point2D b = {12, 12}, c = {24, 24};
+  for (int i = 0; i < 32; i++)
+    for (int j = 0; j < 32; j++) {
+      const geom::Point2D a = {0.5 + i * ulp, 0.5 + j * ulp};
+      const int expected = (j > i) - (j < i);
+      EXPECT_EQ(geom::Orient2D(a, b, c), expected);
+      EXPECT_EQ(geom::Orient2D(b, c, a), expected);
+      EXPECT_EQ(geom::Orient2D(a, c, b), -expected);
+      EXPECT_EQ(geom::CrossProductSign(b, c, b, a), expected);
+    }
+}
+
+TEST(CompareXAtYTest, CrossingAtInexactX) {
+  // Both cross y = 1 at x = 1/3, which isn't representable
+  const geom::Segment2D lhs = {{0, 0}, {1, 3}};
+  const geom::Segment2D rhs = {{1, -1}, {0, 2}};
+  EXPECT_EQ(geom::CompareXAtY(lhs, rhs, 1), 0);
+  EXPECT_EQ(geom::CompareXAtY(rhs, lhs, 1), 0);
+  EXPECT_EQ(geom::CompareXAtY(lhs, rhs, std::nextafter(1, 2)), 1);
+  EXPECT_EQ(geom::CompareXAtY(lhs, rhs, std::nextafter(1, 0)), -1);
+
+  const geom::Segment2D horizontal = {{0, 1}, {5, 1}};
+  EXPECT_EQ(geom::CompareXAtY(horizontal, lhs, 1), -1);
+  EXPECT_EQ(geom::CompareXAtY(lhs, {{1, 1}, {2, 1}}, 1), -1);
+
+  // Cached inverse slopes give the same signs
+  const geom::SlopedSegment2D sloped_lhs(lhs), sloped_rhs(rhs);
+  EXPECT_EQ(geom::CompareXAtY(sloped_lhs, sloped_rhs, 1), 0);
+  EXPECT_EQ(geom::CompareXAtY(sloped_lhs, sloped_rhs, std::nextafter(1, 2)),
+            1);
+  EXPECT_EQ(geom::CompareXAtY(sloped_lhs, sloped_rhs, std::nextafter(1, 0)),
+            -1);
+  EXPECT_EQ(geom::CompareXAtY(geom::SlopedSegment2D(horizontal), sloped_lhs,
+                              1), -1);
+}
+
+TEST(SegmentsOnYSweepLineTest, NeighboursOfManySegmentsThroughPoint) {
+  geom::SegmentsOnYSweepLine segments;
+  segments.SetY(1);
+  const geom::Segment2D left = {{-10, 2}, {-10, 0}};
+  const geom::Segment2D right = {{10, 2}, {10, 0}};
+  segments.Add(left, 1);
+  segments.Add(right, 2);
+  // Every one crosses y = 1 at x = 0
+  std::vector<geom::Segment2D> fan;
+  for (int i = 0; i < 64; i++) {
+    fan.push_back({{i / 8.0 - 4, 2}, {4 - i / 8.0, 0}});
+    segments.Add(fan.back(), 3);
+  }
+
+  for (const geom::Segment2D& segment : fan) {
+    EXPECT_EQ(segments.FirstLeft(segment), left);
+    EXPECT_EQ(segments.FirstRight(segment), right);
+  }
+  EXPECT_EQ(segments.FirstLeft(geom::Point2D{0, 1}), left);
+  EXPECT_EQ(segments.FirstLeftTag({0, 1}), 1);
+  EXPECT_EQ(segments.FirstLeftTag({1, 1}), 3);
+  EXPECT_EQ(segments.FirstLeftTag({-11, 1}), std::nullopt);
+
+  segments.Remove(left);
+  EXPECT_EQ(segments.FirstLeft(fan.front()), std::nullopt);
+  EXPECT_EQ(segments.FirstRight(right), std::nullopt);
+}
+
+TEST(PolygonShapeTest, Classification) {
+  const geom::Polygon2D convex(
+      std::vector<geom::Point2D>{{0, 0}, {2, -1}, {4, 0}, {3, 3}, {1, 3}});
+  EXPECT_EQ(geom::ClassifyPolygon(convex), geom::CONVEX);
+
+  // Collinear vertices aren't fan-triangulated
+  const geom::Polygon2D with_straight_angle(
+      std::vector<geom::Point2D>{{0, 0}, {2, 0}, {4, 0}, {4, 4}});
+  EXPECT_EQ(geom::ClassifyPolygon(with_straight_angle),
+            geom::SIMPLE_Y_MONOTONE);
+
+  const geom::Polygon2D y_monotone(std::vector<geom::Point2D>{
+      {0, 0}, {-1, 1}, {3, 3}, {-2, 5}, {4, 6}, {5, 3}, {2, 2}});
+  EXPECT_EQ(geom::ClassifyPolygon(y_monotone), geom::SIMPLE_Y_MONOTONE);
+  EXPECT_TRUE(geom::IsSimpleYMonotone(y_monotone));
+
+  // One START and one END, but the chains cross twice
+  const geom::Polygon2D crossed_chains(std::vector<geom::Point2D>{
+      {0, 4}, {1, 3}, {-1, 2}, {1, 1}, {0, 0}});
+  EXPECT_EQ(geom::ClassifyPolygon(crossed_chains), geom::UNKNOWN_SHAPE);
+  EXPECT_EQ(geom::ClassifyPolygon(crossed_chains, true),
+            geom::SIMPLE_Y_MONOTONE);
+
+  // Ring pinched at a repeated vertex
+  const geom::Polygon2D pinched(std::vector<geom::Point2D>{
+      {3, 3}, {3.5, 2}, {3, 1.5}, {0, 3}, {3, 3}});
+  EXPECT_FALSE(geom::IsSimpleYMonotone(pinched));
+
+  const geom::Polygon2D with_split(test_polygons[1]);
+  EXPECT_EQ(geom::ClassifyPolygon(with_split), geom::UNKNOWN_SHAPE);
+  EXPECT_FALSE(geom::IsSimpleYMonotone(with_split));
+
+  for (const std::vector<geom::Point2D>& polygon_v :
+       self_intersecting_polygons)
+    EXPECT_EQ(geom::ClassifyPolygon(geom::Polygon2D(polygon_v)),
+              geom::UNKNOWN_SHAPE);
+}
+
+TEST(PolygonShapeTest, RingsCheckMatchesBruteForce) {
+  // Small grid gives plenty of touching and overlapping edges
+  std::mt19937 random(7);
+  std::uniform_int_distribution<int> coordinate(0, 4);
+  std::uniform_int_distribution<size_t> size(3, 9);
+  const std::pmr::vector<geom::Polygon2D> no_holes;
+  for (int i = 0; i < 5000; i++) {
+    std::vector<geom::Point2D> polygon_v(size(random));
+    for (geom::Point2D& point : polygon_v)
+      point = {static_cast<double>(coordinate(random)),
+               static_cast<double>(coordinate(random))};
+    const geom::Polygon2D polygon(polygon_v);
+    if (polygon.Size() < 3)
+      continue;
+    EXPECT_EQ(!geom::CheckPolygonWithHoles(polygon, no_holes),
+              geom::IsSimpleBruteForce(polygon));
+  }
+}
+
+TEST(PolygonShapeTest, RingsCheckOfHoles) {
+  const geom::Polygon2D polygon = geom::Polygon2D::FromRing(
+      polygon_with_holes[0].data(),
+      polygon_with_holes[0].data() + polygon_with_holes[0].size());
+  auto Check = [&](const std::vector<std::vector<geom::Point2D> >& rings) {
+    std::pmr::vector<geom::Polygon2D> holes;
+    for (const std::vector<geom::Point2D>& ring : rings)
+      holes.push_back(geom::Polygon2D::HoleFromRing(
+          ring.data(), ring.data() + ring.size()));
+    return geom::CheckPolygonWithHoles(polygon, holes);
+  };
+  const std::vector<std::vector<geom::Point2D> > holes(
+      std::begin(polygon_with_holes) + 1, std::end(polygon_with_holes));
+  EXPECT_EQ(Check(holes), std::nullopt);
+
+  const std::vector<geom::Point2D> outside = {{11, 1}, {12, 1}, {12, 2}};
+  const std::vector<geom::Point2D> around = {
+      {-1, -1}, {11, -1}, {11, 11}, {-1, 11}};
+  const std::vector<geom::Point2D> inside_first = {
+      {2.5, 2.5}, {3.5, 2.5}, {3, 3.5}};
+  for (const std::vector<geom::Point2D>& misplaced :
+       {outside, around, inside_first}) {
+    std::vector<std::vector<geom::Point2D> > rings = holes;
+    rings.push_back(misplaced);
+    const std::optional<geom::RingsDefect> defect = Check(rings);
+    ASSERT_TRUE(defect);
+    EXPECT_EQ(defect->type, geom::RingsDefect::MISPLACED_HOLE);
+    EXPECT_EQ(defect->hole, 3);
+  }
+
+  const std::vector<std::vector<geom::Point2D> > intersections[] = {
+    // Crossing the polygon
+    {{{8, 5}, {11, 6}, {8, 7}}},
+    // Touching the polygon at a vertex and at an edge
+    {{{10, 10}, {9, 8}, {8, 9}}},
+    {{{10, 5}, {9, 6}, {9, 4}}},
+    // Edge lying on an edge of the polygon
+    {{{10, 3}, {12, 4}, {10, 6}}},
+    // Touching each other
+    {{{1, 1}, {2, 1}, {2, 2}}, {{2, 2}, {3, 1}, {3, 2}}},
+    {{{1, 5}, {5, 5}, {3, 6}}, {{2, 4}, {4, 4}, {3, 5}}},
+    // Bow tie
+    {{{1, 1}, {3, 3}, {3, 1}, {1, 3}}}};
+  for (const std::vector<std::vector<geom::Point2D> >& rings :
+       intersections) {
+    const std::optional<geom::RingsDefect> defect = Check(rings);
+    ASSERT_TRUE(defect);
+    EXPECT_EQ(defect->type, geom::RingsDefect::INTERSECTION);
+  }
+}
+
 TEST_P(SimpleIntersectionTest, DcelResolveIntercestion) {
   geom::Polygon2D polygon(GetInitialPolygonVector());
   geom::DcelPolygon2D dcel_polygon(polygon);
@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+
+#include <geom_utils.h>
+#include <polygon2d.h>
+#include <vertex_kernels.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace decomposition_tests {
+
+namespace {
+
+std::vector<geom::VertexKernelsIsa> SupportedIsas() {
+  std::vector<geom::VertexKernelsIsa> isas;
+  for (geom::VertexKernelsIsa isa :
+       {geom::SCALAR_KERNELS, geom::SSE2_KERNELS, geom::AVX2_KERNELS})
+    if (isa <= geom::BestVertexKernelsIsa())
+      isas.push_back(isa);
+  return isas;
+}
+
+geom::RingCoordinates MakeRing(const std::vector<geom::Point2D>& points) {
+  geom::RingCoordinates ring;
+  ring.Reserve(points.size());
+  for (const geom::Point2D& point : points)
+    ring.PushBack(point);
+  ring.Close();
+  return ring;
+}
+
+// Vertex type by its definition
+geom::Polygon2D::VertexType ExpectedType(const geom::Point2D& prev,
+                                         const geom::Point2D& current,
+                                         const geom::Point2D& next) {
+  const geom::YFirstPoint2DComparator less;
+  const bool reflex = geom::Orient2D(current, prev, next) < 0;
+  if (less(prev, current) && less(next, current))
+    return reflex ? geom::Polygon2D::SPLIT : geom::Polygon2D::START;
+  if (less(current, prev) && less(current, next))
+    return reflex ? geom::Polygon2D::MERGE : geom::Polygon2D::END;
+  return less(current, next) ? geom::Polygon2D::LEFT_REGULAR
+                             : geom::Polygon2D::RIGHT_REGULAR;
+}
+
+void ExpectTypesByDefinition(const std::vector<geom::Point2D>& points) {
+  const geom::RingCoordinates ring = MakeRing(points);
+  const size_t size = points.size();
+  for (geom::VertexKernelsIsa isa : SupportedIsas()) {
+    std::vector<geom::Polygon2D::VertexType> types(size);
+    geom::ClassifyVertices(ring, 0, size, types.data(), isa);
+    for (size_t i = 0; i < size; i++)
+      EXPECT_EQ(types[i], ExpectedType(points[(i + size - 1) % size],
+                                       points[i], points[(i + 1) % size]))
+          << "isa " << isa << " vertex " << i;
+  }
+}
+
+}  // namespace
+
+TEST(VertexKernelsTest, TypesOfRandomRings) {
+  std::mt19937 random(7);
+  std::uniform_real_distribution<double> coordinate(-100, 100);
+  // Small grid gives equal y, collinear and repeated vertices
+  std::uniform_int_distribution<int> grid(0, 3);
+  for (size_t size : {1, 2, 3, 5, 8, 13, 64}) {
+    for (int i = 0; i < 20; i++) {
+      std::vector<geom::Point2D> points, grid_points;
+      for (size_t j = 0; j < size; j++) {
+        points.push_back({coordinate(random), coordinate(random)});
+        grid_points.push_back({double(grid(random)), double(grid(random))});
+      }
+      ExpectTypesByDefinition(points);
+      ExpectTypesByDefinition(grid_points);
+    }
+  }
+}
+
+TEST(VertexKernelsTest, TypesOfNearlyCollinearVertices) {
+  // Middle vertices are a few ulps off the line y = x,
+  // so orientation is left to the exact predicate
+  const double ulp = std::ldexp(1, -53);
+  std::vector<geom::Point2D> points = {{24, 24}};
+  for (int i = 0; i < 16; i++)
+    points.push_back({0.5 + (i % 5) * ulp, 0.5 + (i % 3) * ulp});
+  points.push_back({12, 12});
+  ExpectTypesByDefinition(points);
+}
+
+TEST(VertexKernelsTest, SignedArea) {
+  // Square 4x4 with vertices on its sides, far from the origin
+  for (double offset : {0.0, std::ldexp(1, 30)}) {
+    std::vector<geom::Point2D> points;
+    for (int i = 0; i < 4; i++)
+      points.push_back({offset + i, offset});
+    for (int i = 0; i < 4; i++)
+      points.push_back({offset + 4, offset + i});
+    for (int i = 0; i < 4; i++)
+      points.push_back({offset + 4 - i, offset + 4});
+    for (int i = 0; i < 4; i++)
+      points.push_back({offset, offset + 4 - i});
+    const geom::RingCoordinates ring = MakeRing(points);
+    geom::RingCoordinates reversed = MakeRing(points);
+    reversed.Reverse();
+    for (geom::VertexKernelsIsa isa : SupportedIsas()) {
+      EXPECT_EQ(geom::DoubleSignedArea(ring, isa), 32) << "isa " << isa;
+      EXPECT_EQ(geom::DoubleSignedArea(reversed, isa), -32) << "isa " << isa;
+    }
+  }
+
+  EXPECT_EQ(geom::DoubleSignedArea(MakeRing({})), 0);
+  EXPECT_EQ(geom::DoubleSignedArea(MakeRing({{1, 1}, {2, 2}})), 0);
+}
+
+}  // decomposition_tests
@@ -0,0 +1,575 @@
+#include <polygon_formats.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <utility>
+
+namespace geom {
+
+namespace {
+
+// Nesting deeper than this is taken as malformed data,
+// so hostile input can't exhaust the stack
+constexpr int kMaxDepth = 256;
+
+std::string ErrorAt(const char* what, size_t offset) {
+  return std::string(what) + " at byte " + std::to_string(offset);
+}
+
+void DropClosingPoint(std::vector<Point2D>* ring) {
+  if (ring->size() > 1 && ring->front().x == ring->back().x &&
+      ring->front().y == ring->back().y)
+    ring->pop_back();
+}
+
+// Bounds-checked cursor over binary data of either byte order
+class ByteReader {
+ public:
+  ByteReader(const char* data, size_t size) : data_(data), size_(size) {}
+
+  bool AtEnd() const { return offset_ == size_; }
+  size_t Offset() const { return offset_; }
+  size_t Left() const { return size_ - offset_; }
+
+  bool Skip(size_t bytes) {
+    if (Left() < bytes)
+      return false;
+    offset_ += bytes;
+    return true;
+  }
+
+  bool ReadUint8(uint8_t* value) {
+    uint64_t bits;
+    if (!ReadUnsigned<1>(true, &bits))
+      return false;
+    *value = static_cast<uint8_t>(bits);
+    return true;
+  }
+
+  bool ReadUint32(bool little_endian, uint32_t* value) {
+    uint64_t bits;
+    if (!ReadUnsigned<4>(little_endian, &bits))
+      return false;
+    *value = static_cast<uint32_t>(bits);
+    return true;
+  }
+
+  bool ReadDouble(bool little_endian, double* value) {
+    uint64_t bits;
+    if (!ReadUnsigned<8>(little_endian, &bits))
+      return false;
+    std::memcpy(value, &bits, sizeof(*value));
+    return true;
+  }
+
+ private:
+  template<size_t kBytes>
+  bool ReadUnsigned(bool little_endian, uint64_t* value) {
+    if (Left() < kBytes)
+      return false;
+    const unsigned char* bytes =
+        reinterpret_cast<const unsigned char*>(data_ + offset_);
+    *value = 0;
+    for (size_t i = 0; i < kBytes; i++) {
+      const size_t byte = little_endian ? i : kBytes - 1 - i;
+      *value |= uint64_t(bytes[byte]) << (8 * i);
+    }
+    offset_ += kBytes;
+    return true;
+  }
+
+  const char* data_;
+  size_t size_;
+  size_t offset_ = 0;
+};
+
+// Point count, then x, y and dimensions - 2 more coordinates of each point
+bool ReadRing(ByteReader* bytes, bool little_endian, size_t dimensions,
+              std::vector<Point2D>* ring) {
+  uint32_t size;
+  if (!bytes->ReadUint32(little_endian, &size) ||
+      bytes->Left() / (8 * dimensions) < size)
+    return false;
+  ring->clear();
+  ring->reserve(size);
+  for (uint32_t i = 0; i < size; i++) {
+    Point2D point;
+    if (!bytes->ReadDouble(little_endian, &point.x) ||
+        !bytes->ReadDouble(little_endian, &point.y) ||
+        !bytes->Skip(8 * (dimensions - 2)))
+      return false;
+    ring->push_back(point);
+  }
+  DropClosingPoint(ring);
+  return true;
+}
+
+// Ring count, then the rings, the outer one first
+bool ReadPolygon(ByteReader* bytes, bool little_endian, size_t dimensions,
+                 InputPolygon* polygon) {
+  uint32_t rings;
+  if (!bytes->ReadUint32(little_endian, &rings))
+    return false;
+  polygon->ring.clear();
+  polygon->holes.clear();
+  for (uint32_t i = 0; i < rings; i++) {
+    std::vector<Point2D>* ring =
+        i == 0 ? &polygon->ring : &polygon->holes.emplace_back();
+    if (!ReadRing(bytes, little_endian, dimensions, ring))
+      return false;
+  }
+  return true;
+}
+
+class FlatBinaryReader : public PolygonReader {
+ public:
+  FlatBinaryReader(const char* data, size_t size) : bytes_(data, size) {}
+
+  bool Next(InputPolygon* polygon) override {
+    if (!left_) {
+      // Empty data is an empty collection
+      if (bytes_.AtEnd())
+        return false;
+      uint32_t count;
+      if (!bytes_.ReadUint32(true, &count))
+        return Fail();
+      left_ = count;
+    }
+    if (*left_ == 0)
+      return false;
+    if (!ReadPolygon(&bytes_, true, 2, polygon))
+      return Fail();
+    --*left_;
+    return true;
+  }
+
+ private:
+  bool Fail() {
+    error_ = ErrorAt("truncated polygon", bytes_.Offset());
+    left_ = 0;
+    return false;
+  }
+
+  ByteReader bytes_;
+  std::optional<uint32_t> left_;
+};
+
+class WkbReader : public PolygonReader {
+ public:
+  WkbReader(const char* data, size_t size) : bytes_(data, size) {}
+
+  bool Next(InputPolygon* polygon) override {
+    while (next_pending_ == pending_.size()) {
+      pending_.clear();
+      next_pending_ = 0;
+      if (failed_ || bytes_.AtEnd())
+        return false;
+      if (!ReadGeometry(0)) {
+        error_ = ErrorAt("malformed WKB geometry", bytes_.Offset());
+        failed_ = true;
+        pending_.clear();
+        return false;
+      }
+    }
+    *polygon = std::move(pending_[next_pending_++]);
+    return true;
+  }
+
+ private:
+  static constexpr uint32_t kEwkbZ = 0x80000000;
+  static constexpr uint32_t kEwkbM = 0x40000000;
+  static constexpr uint32_t kEwkbSrid = 0x20000000;
+
+  enum GeometryType {
+    POINT = 1,
+    LINE_STRING,
+    POLYGON,
+    MULTI_POINT,
+    MULTI_LINE_STRING,
+    MULTI_POLYGON,
+    GEOMETRY_COLLECTION
+  };
+
+  // Polygons of the geometry are added to pending_
+  bool ReadGeometry(int depth) {
+    uint8_t byte_order;
+    uint32_t type;
+    if (depth > kMaxDepth || !bytes_.ReadUint8(&byte_order) ||
+        byte_order > 1)
+      return false;
+    const bool little_endian = byte_order == 1;
+    if (!bytes_.ReadUint32(little_endian, &type))
+      return false;
+    size_t dimensions = 2 + ((type & kEwkbZ) != 0) + ((type & kEwkbM) != 0);
+    if ((type & kEwkbSrid) && !bytes_.Skip(4))
+      return false;
+    type &= ~(kEwkbZ | kEwkbM | kEwkbSrid);
+    // ISO types are 1000 higher for Z, 2000 for M and 3000 for ZM
+    switch (type / 1000) {
+      case 0:
+        break;
+      case 1:
+      case 2:
+        dimensions++;
+        break;
+      case 3:
+        dimensions += 2;
+        break;
+      default:
+        return false;
+    }
+    type %= 1000;
+
+    switch (type) {
+      case POINT:
+        return bytes_.Skip(8 * dimensions);
+      case LINE_STRING: {
+        std::vector<Point2D> line;
+        return ReadRing(&bytes_, little_endian, dimensions, &line);
+      }
+      case POLYGON: {
+        InputPolygon polygon;
+        if (!ReadPolygon(&bytes_, little_endian, dimensions, &polygon))
+          return false;
+        // POLYGON EMPTY has no rings
+        if (!polygon.ring.empty())
+          pending_.push_back(std::move(polygon));
+        return true;
+      }
+      case MULTI_POINT:
+      case MULTI_LINE_STRING:
+      case MULTI_POLYGON:
+      case GEOMETRY_COLLECTION: {
+        uint32_t count;
+        if (!bytes_.ReadUint32(little_endian, &count))
+          return false;
+        for (uint32_t i = 0; i < count; i++)
+          if (!ReadGeometry(depth + 1))
+            return false;
+        return true;
+      }
+      default:
+        return false;
+    }
+  }
+
+  ByteReader bytes_;
+  bool failed_ = false;
+  // Polygons of the last read geometry
+  std::vector<InputPolygon> pending_;
+  size_t next_pending_ = 0;
+};
+
+// Nested arrays of GeoJSON coordinates, leaves are positions
+struct Coordinates {
+  bool is_position = false;
+  Point2D position;
+  std::vector<Coordinates> items;
+};
+
+// Recursive descent over the whole document, values other than
+// geometry types and coordinates are only checked and skipped
+class GeoJsonReader : public PolygonReader {
+ public:
+  GeoJsonReader(const char* data, size_t size) :
+      begin_(data), pos_(data), end_(data + size) {
+    SkipWhitespace();
+    const bool parsed = ParseValue(0);
+    SkipWhitespace();
+    if (!parsed || pos_ != end_)
+      parse_error_ = ErrorAt("malformed JSON", pos_ - begin_);
+  }
+
+  bool Next(InputPolygon* polygon) override {
+    if (next_polygon_ == polygons_.size()) {
+      error_ = parse_error_;
+      return false;
+    }
+    *polygon = std::move(polygons_[next_polygon_++]);
+    return true;
+  }
+
+ private:
+  void SkipWhitespace() {
+    while (pos_ != end_ && std::isspace(static_cast<unsigned char>(*pos_)))
+      pos_++;
+  }
+
+  bool Consume(char c) {
+    SkipWhitespace();
+    if (pos_ == end_ || *pos_ != c)
+      return false;
+    pos_++;
+    return true;
+  }
+
+  bool ParseValue(int depth) {
+    if (depth > kMaxDepth || pos_ == end_)
+      return false;
+    switch (*pos_) {
+      case '{':
+        return ParseObject(depth);
+      case '[':
+        return ParseArray(depth);
+      case '"':
+        return ParseString(nullptr);
+      default:
+        return ParseLiteral();
+    }
+  }
+
+  // Members are parsed in any order,
+  // the geometry is taken when the object is closed
+  bool ParseObject(int depth) {
+    pos_++;
+    if (Consume('}'))
+      return true;
+    std::string type;
+    std::optional<Coordinates> coordinates;
+    do {
+      std::string key;
+      SkipWhitespace();
+      if (!ParseString(&key) || !Consume(':'))
+        return false;
+      SkipWhitespace();
+      bool parsed;
+      if (key == "type" && pos_ != end_ && *pos_ == '"') {
+        parsed = ParseString(&type);
+      } else if (key == "coordinates") {
+        coordinates.emplace();
+        parsed = ParseCoordinates(depth + 1, &*coordinates);
+      } else {
+        parsed = ParseValue(depth + 1);
+      }
+      if (!parsed)
+        return false;
+    } while (Consume(','));
+    if (!Consume('}'))
+      return false;
+    if (!coordinates)
+      return true;
+    if (type == "Polygon")
+      return AddPolygon(*coordinates);
+    if (type == "MultiPolygon") {
+      if (coordinates->is_position)
+        return false;
+      for (const Coordinates& polygon : coordinates->items)
+        if (!AddPolygon(polygon))
+          return false;
+    }
+    return true;
+  }
+
+  bool ParseArray(int depth) {
+    pos_++;
+    if (Consume(']'))
+      return true;
+    do {
+      SkipWhitespace();
+      if (!ParseValue(depth + 1))
+        return false;
+    } while (Consume(','));
+    return Consume(']');
+  }
+
+  // Array of numbers is a position, only its x and y are kept
+  bool ParseCoordinates(int depth, Coordinates* coordinates) {
+    if (depth > kMaxDepth || pos_ == end_ || *pos_ != '[')
+      return false;
+    pos_++;
+    if (Consume(']'))
+      return true;
+    SkipWhitespace();
+    if (pos_ != end_ && *pos_ != '[') {
+      coordinates->is_position = true;
+      double values[2];
+      size_t count = 0;
+      do {
+        SkipWhitespace();
+        double value;
+        if (!ParseNumber(&value))
+          return false;
+        if (count < 2)
+          values[count] = value;
+        count++;
+      } while (Consume(','));
+      coordinates->position = {values[0], values[1]};
+      return count >= 2 && Consume(']');
+    }
+    do {
+      SkipWhitespace();
+      if (!ParseCoordinates(depth + 1, &coordinates->items.emplace_back()))
+        return false;
+    } while (Consume(','));
+    return Consume(']');
+  }
+
+  bool ParseNumber(double* value) {
+    const std::from_chars_result result =
+        std::from_chars(pos_, end_, *value);
+    if (result.ec != std::errc())
+      return false;
+    pos_ = result.ptr;
+    return true;
+  }
+
+  // Numbers, true, false and null
+  bool ParseLiteral() {
+    const char* start = pos_;
+    while (pos_ != end_ &&
+           (std::isalnum(static_cast<unsigned char>(*pos_)) ||
+            *pos_ == '-' || *pos_ == '+' || *pos_ == '.'))
+      pos_++;
+    return pos_ != start;
+  }
+
+  // Escapes other than \uXXXX are decoded, those aren't needed
+  // for the type names and are kept escaped
+  bool ParseString(std::string* value) {
+    if (pos_ == end_ || *pos_ != '"')
+      return false;
+    pos_++;
+    while (pos_ != end_ && *pos_ != '"') {
+      char c = *pos_++;
+      if (c == '\\') {
+        if (pos_ == end_)
+          return false;
+        c = *pos_++;
+        switch (c) {
+          case 'b': c = '\b'; break;
+          case 'f': c = '\f'; break;
+          case 'n': c = '\n'; break;
+          case 'r': c = '\r'; break;
+          case 't': c = '\t'; break;
+          case 'u':
+            if (value)
+              value->push_back('\\');
+            break;
+          default: break;
+        }
+      }
+      if (value)
+        value->push_back(c);
+    }
+    if (pos_ == end_)
+      return false;
+    pos_++;
+    return true;
+  }
+
+  bool AddPolygon(const Coordinates& coordinates) {
+    if (coordinates.is_position)
+      return false;
+    // Empty polygon has no rings
+    if (coordinates.items.empty())
+      return true;
+    InputPolygon polygon;
+    for (size_t i = 0; i < coordinates.items.size(); i++) {
+      const Coordinates& ring_coordinates = coordinates.items[i];
+      if (ring_coordinates.is_position)
+        return false;
+      std::vector<Point2D>& ring =
+          i == 0 ? polygon.ring : polygon.holes.emplace_back();
+      ring.reserve(ring_coordinates.items.size());
+      for (const Coordinates& position : ring_coordinates.items) {
+        if (!position.is_position)
+          return false;
+        ring.push_back(position.position);
+      }
+      DropClosingPoint(&ring);
+    }
+    polygons_.push_back(std::move(polygon));
+    return true;
+  }
+
+  const char* begin_;
+  const char* pos_;
+  const char* end_;
+  std::string parse_error_;
+  std::vector<InputPolygon> polygons_;
+  size_t next_polygon_ = 0;
+};
+
+// Little-endian, returns the position after the value
+char* StoreUint32(uint32_t value, char* out) {
+  for (size_t i = 0; i < 4; i++)
+    *out++ = static_cast<char>(value >> (8 * i));
+  return out;
+}
+
+char* StoreDouble(double value, char* out) {
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  for (size_t i = 0; i < 8; i++)
+    *out++ = static_cast<char>(bits >> (8 * i));
+  return out;
+}
+
+std::string Lowercase(std::string value) {
+  std::transform(value.begin(), value.end(), value.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return value;
+}
+
+}  // namespace
+
+PolygonFormat PolygonFormatOfPath(const std::string& path) {
+  const size_t dot = path.find_last_of('.');
+  if (dot == std::string::npos)
+    return UNKNOWN_FORMAT;
+  const std::string extension = Lowercase(path.substr(dot + 1));
+  if (extension == "bin")
+    return FLAT_BINARY_FORMAT;
+  if (extension == "wkb")
+    return WKB_FORMAT;
+  if (extension == "geojson" || extension == "json")
+    return GEOJSON_FORMAT;
+  return UNKNOWN_FORMAT;
+}
+
+PolygonFormat PolygonFormatOfName(const std::string& name) {
+  const std::string lowercase = Lowercase(name);
+  if (lowercase == "binary")
+    return FLAT_BINARY_FORMAT;
+  if (lowercase == "wkb")
+    return WKB_FORMAT;
+  if (lowercase == "geojson")
+    return GEOJSON_FORMAT;
+  return UNKNOWN_FORMAT;
+}
+
+std::unique_ptr<PolygonReader> MakePolygonReader(PolygonFormat format,
+                                                 const char* data,
+                                                 size_t size) {
+  switch (format) {
+    case FLAT_BINARY_FORMAT:
+      return std::make_unique<FlatBinaryReader>(data, size);
+    case WKB_FORMAT:
+      return std::make_unique<WkbReader>(data, size);
+    case GEOJSON_FORMAT:
+      return std::make_unique<GeoJsonReader>(data, size);
+    default:
+      return nullptr;
+  }
+}
+
+void AppendIndexedMesh(const IndexedTriangles2D& mesh,
+                       std::vector<char>* out) {
+  const size_t begin = out->size();
+  out->resize(begin + 8 + 16 * mesh.points.size() + 4 * mesh.indices.size());
+  char* pos = out->data() + begin;
+  pos = StoreUint32(static_cast<uint32_t>(mesh.points.size()), pos);
+  pos = StoreUint32(static_cast<uint32_t>(mesh.indices.size()), pos);
+  for (const Point2D& point : mesh.points) {
+    pos = StoreDouble(point.x, pos);
+    pos = StoreDouble(point.y, pos);
+  }
+  for (const uint32_t index : mesh.indices)
+    pos = StoreUint32(index, pos);
+}
+
+}  // geom
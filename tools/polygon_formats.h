@@ -0,0 +1,68 @@
+#ifndef POLYGON_FORMATS_H
+#define POLYGON_FORMATS_H
+
+#include <triangulation_base_geometry.h>
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace geom {
+
+// Polygon of an input collection, as taken by TriangulateBatch
+// Closing points of closed rings are dropped by the readers
+using InputPolygon = PolygonWithHoles2D;
+
+enum PolygonFormat {
+  UNKNOWN_FORMAT,
+  // Little-endian, uint32 counts and double coordinates:
+  // number of polygons, then for every polygon number of rings
+  // (the outer one first, then the holes) and for every ring
+  // number of points followed by x, y of each of them
+  FLAT_BINARY_FORMAT,
+  // Concatenated WKB geometries of either byte order,
+  // polygons are taken from Polygons, MultiPolygons
+  // and GeometryCollections, other geometries are skipped
+  // Z and M coordinates (ISO and EWKB) and EWKB SRID are dropped
+  WKB_FORMAT,
+  // Polygons and MultiPolygons anywhere in the document
+  // (bare geometries, Features, FeatureCollections and
+  // GeometryCollections), the whole document is parsed at once
+  GEOJSON_FORMAT
+};
+
+// By extension: .bin, .wkb, .geojson or .json
+PolygonFormat PolygonFormatOfPath(const std::string& path);
+// By name: binary, wkb or geojson
+PolygonFormat PolygonFormatOfName(const std::string& name);
+
+// Gives polygons of the data one by one in the order of the data
+// Data must outlive the reader
+class PolygonReader {
+ public:
+  virtual ~PolygonReader() = default;
+
+  // False at the end of data and on malformed data
+  virtual bool Next(InputPolygon* polygon) = 0;
+  // Empty unless Next stopped on malformed data
+  const std::string& Error() const { return error_; }
+
+ protected:
+  std::string error_;
+};
+
+std::unique_ptr<PolygonReader> MakePolygonReader(PolygonFormat format,
+                                                 const char* data,
+                                                 size_t size);
+
+// Appends the mesh in the output format of the triangulate tool,
+// little-endian: uint32 number of points, uint32 number of indices,
+// x, y doubles of every point, then the uint32 indices,
+// three per triangle
+void AppendIndexedMesh(const IndexedTriangles2D& mesh,
+                       std::vector<char>* out);
+
+}  // geom
+
+#endif  // POLYGON_FORMATS_H
@@ -0,0 +1,250 @@
+#include <polygon_formats.h>
+#include <triangulation.h>
+#include <triangulation_mapped_file.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr char kUsage[] =
+    "Usage: triangulate [options] <input>...\n"
+    "Triangulates every polygon of the inputs and writes indexed meshes\n"
+    "to <input>.mesh\n"
+    "Self-intersections of polygons without holes are resolved,\n"
+    "polygons with holes whose rings cross, touch or are misplaced\n"
+    "are reported and get empty meshes\n"
+    "\n"
+    "Options:\n"
+    "  --format=binary|wkb|geojson  format of the inputs\n"
+    "                               (by default by extension:\n"
+    "                               .bin, .wkb, .geojson or .json)\n"
+    "  --threads=N                  number of worker threads,\n"
+    "                               0 for all the cores (default)\n"
+    "  --output-dir=DIR             write the meshes to DIR\n"
+    "  --help                       print this message\n";
+
+// Polygons are read and triangulated in chunks of about this many
+// vertices, so memory doesn't grow with the input,
+// the next chunk is parsed and the previous one is written
+// while a chunk is triangulated
+constexpr size_t kChunkVertices = 1 << 20;
+constexpr size_t kChunkPolygons = 1 << 16;
+
+struct ToolOptions {
+  geom::PolygonFormat format = geom::UNKNOWN_FORMAT;
+  size_t num_threads = 0;
+  std::string output_dir;
+  std::vector<std::string> inputs;
+};
+
+bool ParseArguments(int argc, char** argv, ToolOptions* options) {
+  for (int i = 1; i < argc; i++) {
+    const std::string argument = argv[i];
+    auto Value = [&](const std::string& prefix, std::string* value) {
+      if (argument.compare(0, prefix.size(), prefix) != 0)
+        return false;
+      *value = argument.substr(prefix.size());
+      return true;
+    };
+    std::string value;
+    if (Value("--format=", &value)) {
+      options->format = geom::PolygonFormatOfName(value);
+      if (options->format == geom::UNKNOWN_FORMAT)
+        return false;
+    } else if (Value("--threads=", &value)) {
+      char* end;
+      options->num_threads = std::strtoul(value.c_str(), &end, 10);
+      if (value.empty() || *end != '\0')
+        return false;
+    } else if (Value("--output-dir=", &value)) {
+      options->output_dir = value;
+    } else if (argument.compare(0, 2, "--") == 0) {
+      return false;
+    } else {
+      options->inputs.push_back(argument);
+    }
+  }
+  return !options->inputs.empty();
+}
+
+std::string MeshPath(const std::string& input, const std::string& output_dir) {
+  std::filesystem::path path(input + ".mesh");
+  if (!output_dir.empty())
+    path = std::filesystem::path(output_dir) / path.filename();
+  return path.string();
+}
+
+size_t VerticesCount(const geom::InputPolygon& polygon) {
+  size_t count = polygon.ring.size();
+  for (const std::vector<geom::Point2D>& hole : polygon.holes)
+    count += hole.size();
+  return count;
+}
+
+struct Chunk {
+  std::vector<geom::InputPolygon> polygons;
+  size_t vertices = 0;
+  // False if the reader has no polygons after the chunk
+  bool more = false;
+};
+
+void ReadChunk(geom::PolygonReader* reader, Chunk* chunk) {
+  chunk->polygons.clear();
+  chunk->vertices = 0;
+  chunk->more = true;
+  geom::InputPolygon polygon;
+  while (chunk->vertices < kChunkVertices &&
+         chunk->polygons.size() < kChunkPolygons) {
+    if (!reader->Next(&polygon)) {
+      chunk->more = false;
+      return;
+    }
+    chunk->vertices += VerticesCount(polygon);
+    chunk->polygons.push_back(std::move(polygon));
+  }
+}
+
+struct FileTotals {
+  size_t polygons = 0;
+  size_t vertices = 0;
+  size_t triangles = 0;
+  size_t bytes_written = 0;
+};
+
+// Returns false and prints the reason if the file isn't processed
+// completely, meshes of the polygons before a malformed one are written
+// Rings of polygons with holes are checked first, TriangulateWithHoles
+// doesn't accept invalid ones
+bool TriangulateInput(const std::string& input, const ToolOptions& options) {
+  const geom::PolygonFormat format =
+      options.format != geom::UNKNOWN_FORMAT ?
+      options.format : geom::PolygonFormatOfPath(input);
+  if (format == geom::UNKNOWN_FORMAT) {
+    std::fprintf(stderr, "%s: unknown format, use --format\n",
+                 input.c_str());
+    return false;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  const geom::MappedFile file(input);
+  if (!file.IsOpen()) {
+    std::fprintf(stderr, "%s: can't be read\n", input.c_str());
+    return false;
+  }
+  const std::unique_ptr<geom::PolygonReader> reader =
+      geom::MakePolygonReader(format, static_cast<const char*>(file.Data()),
+                              file.Size());
+  const std::string output = MeshPath(input, options.output_dir);
+  std::FILE* writer = std::fopen(output.c_str(), "wb");
+  if (!writer) {
+    std::fprintf(stderr, "%s: can't be written\n", output.c_str());
+    return false;
+  }
+  bool written = true;
+
+  // Threads of the batch are the ones of the library pool,
+  // kept for the whole run
+  geom::TriangulationOptions batch_options;
+  batch_options.num_threads = options.num_threads;
+  FileTotals totals;
+  Chunk chunk, next_chunk;
+  std::vector<geom::IndexedTriangles2D> meshes, written_meshes;
+  std::vector<char> buffer;
+  std::vector<std::string> errors;
+  size_t invalid_polygons = 0;
+  std::future<void> reading;
+  std::future<void> writing;
+  ReadChunk(reader.get(), &chunk);
+  while (!chunk.polygons.empty()) {
+    if (chunk.more) {
+      reading = std::async(std::launch::async, [&]() {
+        ReadChunk(reader.get(), &next_chunk);
+      });
+    }
+    geom::TriangulateBatch(chunk.polygons, batch_options, &meshes, &errors);
+    for (size_t i = 0; i < chunk.polygons.size(); i++) {
+      totals.triangles += meshes[i].indices.size() / 3;
+      if (!errors[i].empty()) {
+        std::fprintf(stderr, "%s: polygon %zu: %s\n", input.c_str(),
+                     totals.polygons + i, errors[i].c_str());
+        invalid_polygons++;
+      }
+    }
+    totals.polygons += chunk.polygons.size();
+    totals.vertices += chunk.vertices;
+
+    if (writing.valid())
+      writing.get();
+    written_meshes.swap(meshes);
+    writing = std::async(std::launch::async, [&]() {
+      for (const geom::IndexedTriangles2D& mesh : written_meshes) {
+        buffer.clear();
+        geom::AppendIndexedMesh(mesh, &buffer);
+        totals.bytes_written += buffer.size();
+        written &= std::fwrite(buffer.data(), 1, buffer.size(), writer) ==
+                   buffer.size();
+      }
+    });
+
+    if (reading.valid()) {
+      reading.get();
+      std::swap(chunk, next_chunk);
+    } else {
+      chunk.polygons.clear();
+    }
+  }
+  if (writing.valid())
+    writing.get();
+  written &= std::fclose(writer) == 0;
+
+  const double seconds = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  std::printf("%s: %zu polygons, %zu vertices, %zu triangles in %.3f s "
+              "(%.1f MB/s read, %.1f MB/s written, %.2f M vertices/s)\n",
+              input.c_str(), totals.polygons, totals.vertices,
+              totals.triangles, seconds, file.Size() / seconds / 1e6,
+              totals.bytes_written / seconds / 1e6,
+              totals.vertices / seconds / 1e6);
+  if (!reader->Error().empty()) {
+    std::fprintf(stderr, "%s: %s\n", input.c_str(), reader->Error().c_str());
+    return false;
+  }
+  if (!written) {
+    std::fprintf(stderr, "%s: can't be written\n", output.c_str());
+    return false;
+  }
+  if (invalid_polygons != 0) {
+    std::fprintf(stderr, "%s: %zu invalid polygons got empty meshes\n",
+                 input.c_str(), invalid_polygons);
+    return false;
+  }
+  return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--help") == 0) {
+      std::fputs(kUsage, stdout);
+      return 0;
+    }
+  }
+  ToolOptions options;
+  if (!ParseArguments(argc, argv, &options)) {
+    std::fputs(kUsage, stderr);
+    return 2;
+  }
+  bool succeeded = true;
+  for (const std::string& input : options.inputs)
+    succeeded = TriangulateInput(input, options) && succeeded;
+  return succeeded ? 0 : 1;
+}
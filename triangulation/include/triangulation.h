@@ -2,12 +2,218 @@
 #define TRIAGULATION_EXPOSE_TRIANGULATION_H
 
 #include <triangulation_base_geometry.h>
+#include <triangulation_stats.h>
 
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <string>
 #include <vector>
 
 namespace geom {
 
-std::vector<Triangle2D> Triangulate(const std::vector<Point2D>& polygon);
+// All the functions below are reentrant and may be called concurrently
+// from any number of threads, as long as a TriangulationContext isn't
+// used by two calls at the same time
+
+// Keeps memory of the internal buffers between Triangulate calls
+// made with it, so steady-state calls make almost no heap allocations
+// (use the indexed Triangulate with a reused result to avoid
+// allocating the output too)
+// Not thread-safe, keep one context per thread
+class TriangulationContext {
+ public:
+  TriangulationContext();
+  // All the memory is requested from upstream
+  explicit TriangulationContext(std::pmr::memory_resource* upstream);
+  ~TriangulationContext();
+
+  TriangulationContext(const TriangulationContext&) = delete;
+  TriangulationContext& operator=(const TriangulationContext&) = delete;
+
+  std::pmr::memory_resource* memory_resource() const;
+
+ private:
+  std::unique_ptr<std::pmr::memory_resource> memory_;
+};
+
+struct TriangulationOptions {
+  enum Orientation {
+    UNKNOWN_ORIENTATION,
+    // In the usual y-up axes
+    CLOCKWISE,
+    COUNTERCLOCKWISE
+  };
+
+  enum Engine {
+    // Ear clipping for polygons with less than ear_clipping_threshold
+    // vertices and for known_simple polygons and simple pieces with less
+    // than simple_ear_clipping_threshold, monotone pipeline for the others
+    AUTO_ENGINE,
+    // Monotone decomposition, O(NlogN)
+    MONOTONE_ENGINE,
+    // Ear clipping, O(N^2) but with small constant
+    // Degenerate pieces it fails on are triangulated by the monotone one
+    EAR_CLIPPING_ENGINE
+  };
+
+  // Number of threads the independent pieces of one polygon are
+  // processed on (0 means number of hardware threads)
+  // Order of output triangles doesn't depend on it
+  // TriangulateBatch spreads the polygons over the threads instead
+  size_t num_threads = 1;
+
+  // Optional, with num_threads != 1 it's used only by the sequential stages
+  TriangulationContext* context = nullptr;
+
+  // Optional, nothing is measured without it
+  // With num_threads != 1 stage times are wall times of the parallel stages
+  TriangulationStats* stats = nullptr;
+
+  // Hints let Triangulate skip the checks of the input,
+  // result is undefined if a hint is wrong
+  // Simple polygon has no self-intersections
+  bool known_simple = false;
+  // Convex polygon is fan-triangulated right away
+  bool known_convex = false;
+  Orientation known_orientation = UNKNOWN_ORIENTATION;
+
+  Engine engine = AUTO_ENGINE;
+  // Engines break even at about 40 vertices in BM_TriangulateSmall,
+  // lowered for polygons with worse ears than the benchmark star
+  size_t ear_clipping_threshold = 32;
+  // Simple polygons skip both the pairwise check before ear clipping
+  // and the intersections sweep of the monotone pipeline,
+  // so the engines break even sooner, at about 32 vertices
+  size_t simple_ear_clipping_threshold = 24;
+};
+
+// Functions below are templates over the coordinate type
+// (see BasicPoint2D), output points of resolved self-intersections
+// are rounded to the nearest for int32_t
+
+template<class T>
+std::vector<BasicTriangle2D<T> > Triangulate(
+    const std::vector<BasicPoint2D<T> >& polygon);
+template<class T>
+std::vector<BasicTriangle2D<T> > Triangulate(
+    const std::vector<BasicPoint2D<T> >& polygon,
+    const TriangulationOptions& options);
+
+// Indexed version of Triangulate
+// result->points starts with a copy of the input polygon
+// so indices of the input vertices are preserved,
+// points of resolved self-intersections are appended after them
+// Vertices carry their input index through the pipeline,
+// so no lookup of points is made for the indices
+template<class T>
+void Triangulate(const std::vector<BasicPoint2D<T> >& polygon,
+                 BasicIndexedTriangles2D<T>* result);
+template<class T>
+void Triangulate(const std::vector<BasicPoint2D<T> >& polygon,
+                 const TriangulationOptions& options,
+                 BasicIndexedTriangles2D<T>* result);
+
+// Version of Triangulate which needs neither the input vector
+// nor the output vector: the ring is read from [first, last)
+// (e.g. a memory-mapped file) and every triangle is handed to sink
+// as soon as it's made
+// Working memory is still O(N) as with the other versions,
+// the ring is copied into the pipeline structures
+// With num_threads != 1 triangles of pieces are collected before sink
+// sees them, to keep the order of the sequential version
+template<class T>
+void Triangulate(
+    const BasicPoint2D<T>* first, const BasicPoint2D<T>* last,
+    const TriangulationOptions& options,
+    const std::function<void(const BasicTriangle2D<T>&)>& sink);
+
+// Polygon file holds x, y of every vertex, triangles file gets
+// x, y of a, b, c of every triangle, both as raw doubles
+// in the native byte order
+// Convenience wrapper of the sink version of Triangulate:
+// polygon file is memory-mapped (read into memory where mapping
+// isn't available) and triangles are written out through a small buffer
+// Returns false if a file can't be read or written
+bool TriangulateFile(const std::string& polygon_path,
+                     const std::string& triangles_path,
+                     const TriangulationOptions& options =
+                         TriangulationOptions());
+
+// Polygon with holes, rings may be of any orientation
+// All the rings go through one sweep, so no bridges between them
+// are needed (nor added to the result)
+// Rings must be simple, must not touch each other
+// and holes must lie inside the polygon,
+// self-intersections aren't resolved here
+// (IsValidPolygonWithHoles checks that for untrusted input)
+// Only num_threads, context, stats and engine of options are used
+template<class T>
+std::vector<BasicTriangle2D<T> > TriangulateWithHoles(
+    const std::vector<BasicPoint2D<T> >& polygon,
+    const std::vector<std::vector<BasicPoint2D<T> > >& holes);
+template<class T>
+std::vector<BasicTriangle2D<T> > TriangulateWithHoles(
+    const std::vector<BasicPoint2D<T> >& polygon,
+    const std::vector<std::vector<BasicPoint2D<T> > >& holes,
+    const TriangulationOptions& options);
+// result->points starts with copies of the polygon and the holes
+// in the given order
+template<class T>
+void TriangulateWithHoles(
+    const std::vector<BasicPoint2D<T> >& polygon,
+    const std::vector<std::vector<BasicPoint2D<T> > >& holes,
+    const TriangulationOptions& options,
+    BasicIndexedTriangles2D<T>* result);
+
+// Checks the requirements of TriangulateWithHoles in O(NlogN),
+// so rings of untrusted input can be rejected before the call
+// Holes skipped by TriangulateWithHoles are skipped here too
+// On rejection error (if given) gets the reason
+template<class T>
+bool IsValidPolygonWithHoles(
+    const std::vector<BasicPoint2D<T> >& polygon,
+    const std::vector<std::vector<BasicPoint2D<T> > >& holes,
+    std::string* error = nullptr);
+
+// Triangulates independent polygons on num_threads worker threads
+// (0 means number of hardware threads)
+// Polygons are balanced between threads with work stealing,
+// results are returned in the order of input polygons
+// Worker threads are kept between calls, so small batches are cheap too
+template<class T>
+std::vector<std::vector<BasicTriangle2D<T> > > TriangulateBatch(
+    const std::vector<std::vector<BasicPoint2D<T> > >& polygons,
+    size_t num_threads = 0);
+// Same with options for every polygon, polygons are spread over
+// options.num_threads threads and each one is triangulated by one thread
+// Every thread has a TriangulationContext of its own for the call,
+// options.context isn't used
+// options.stats gets the totals, stage times are summed over the threads
+template<class T>
+std::vector<std::vector<BasicTriangle2D<T> > > TriangulateBatch(
+    const std::vector<std::vector<BasicPoint2D<T> > >& polygons,
+    const TriangulationOptions& options);
+// Indexed version, results has a result of the indexed Triangulate
+// for every polygon, its buffers are reused
+template<class T>
+void TriangulateBatch(
+    const std::vector<std::vector<BasicPoint2D<T> > >& polygons,
+    const TriangulationOptions& options,
+    std::vector<BasicIndexedTriangles2D<T> >* results);
+// Polygons with holes, every result is the one of the indexed
+// TriangulateWithHoles (so polygons without holes get their
+// self-intersections resolved)
+// With errors given, polygons with holes are checked by
+// IsValidPolygonWithHoles first, rejected ones get empty results
+// and the reason in errors (empty for the accepted ones)
+template<class T>
+void TriangulateBatch(
+    const std::vector<BasicPolygonWithHoles2D<T> >& polygons,
+    const TriangulationOptions& options,
+    std::vector<BasicIndexedTriangles2D<T> >* results,
+    std::vector<std::string>* errors = nullptr);
 
 }  // geom
 
@@ -1,21 +1,51 @@
 #ifndef TRIAGULATION_EXPOSE_TRIANGULATION_BASE_GEOMETRY_H
 #define TRIAGULATION_EXPOSE_TRIANGULATION_BASE_GEOMETRY_H
 
+#include <cstdint>
+#include <vector>
+
 namespace geom {
 
-struct Point2D {
-  double x, y;
-  Point2D() : x(0), y(0) {}
-  Point2D(double x, double y) : x(x), y(y) {}
+// Coordinate type T is one of float, double and int32_t,
+// the library is built for these three only
+// The pipeline itself runs on double, which holds all of them exactly
+
+template<class T>
+struct BasicPoint2D {
+  T x, y;
+  BasicPoint2D() : x(0), y(0) {}
+  BasicPoint2D(T x, T y) : x(x), y(y) {}
 };
 
-struct Triangle2D {
-  Point2D a, b, c;
-  Triangle2D() {}
-  Triangle2D(const Point2D& a, const Point2D& b, const Point2D& c) :
+template<class T>
+struct BasicTriangle2D {
+  BasicPoint2D<T> a, b, c;
+  BasicTriangle2D() {}
+  BasicTriangle2D(const BasicPoint2D<T>& a, const BasicPoint2D<T>& b,
+                  const BasicPoint2D<T>& c) :
       a(a), b(b), c(c) {}
 };
 
+// Triangles as index triples into the shared points array
+// (ready to be uploaded as vertex/index buffers)
+template<class T>
+struct BasicIndexedTriangles2D {
+  std::vector<BasicPoint2D<T> > points;
+  std::vector<uint32_t> indices;
+};
+
+// Outer ring and the holes inside it (see TriangulateWithHoles)
+template<class T>
+struct BasicPolygonWithHoles2D {
+  std::vector<BasicPoint2D<T> > ring;
+  std::vector<std::vector<BasicPoint2D<T> > > holes;
+};
+
+using Point2D = BasicPoint2D<double>;
+using Triangle2D = BasicTriangle2D<double>;
+using IndexedTriangles2D = BasicIndexedTriangles2D<double>;
+using PolygonWithHoles2D = BasicPolygonWithHoles2D<double>;
+
 }  // geom
 
 #endif  // TRIAGULATION_EXPOSE_TRIANGULATION_BASE_GEOMETRY_H
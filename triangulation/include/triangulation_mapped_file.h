@@ -0,0 +1,37 @@
+#ifndef TRIAGULATION_EXPOSE_TRIANGULATION_MAPPED_FILE_H
+#define TRIAGULATION_EXPOSE_TRIANGULATION_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace geom {
+
+// Read-only memory mapping of a whole file, pages are read by the OS
+// on first access and may be dropped again under memory pressure
+// Without POSIX mmap the file is read into memory instead
+// Empty and unreadable files give no data
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  // False if the file can't be opened or mapped
+  bool IsOpen() const;
+  const void* Data() const;
+  size_t Size() const;
+
+ private:
+  bool open_ = false;
+  void* data_ = nullptr;
+  size_t size_ = 0;
+  // Data of the file read without mmap
+  std::vector<char> contents_;
+};
+
+}  // geom
+
+#endif  // TRIAGULATION_EXPOSE_TRIANGULATION_MAPPED_FILE_H
@@ -0,0 +1,33 @@
+#ifndef TRIAGULATION_EXPOSE_TRIANGULATION_STATS_H
+#define TRIAGULATION_EXPOSE_TRIANGULATION_STATS_H
+
+#include <chrono>
+#include <cstddef>
+
+namespace geom {
+
+// Filled by Triangulate when requested in TriangulationOptions
+// Values are added to, so one object may collect totals of several calls
+struct TriangulationStats {
+  // Wall time of the pipeline stages
+  std::chrono::nanoseconds resolve_intersections_time{0};
+  std::chrono::nanoseconds decompose_time{0};
+  std::chrono::nanoseconds triangulate_monotone_time{0};
+  std::chrono::nanoseconds ear_clipping_time{0};
+
+  // Self-intersections found and events processed by the sweep
+  size_t intersections = 0;
+  size_t events = 0;
+
+  // DcelPolygon2D::InsertEdge calls over all the stages
+  // and diagonals cut by the monotone triangulation
+  size_t inserted_edges = 0;
+
+  size_t monotone_pieces = 0;
+  size_t ear_clipped_pieces = 0;
+  size_t triangles = 0;
+};
+
+}  // geom
+
+#endif  // TRIAGULATION_EXPOSE_TRIANGULATION_STATS_H
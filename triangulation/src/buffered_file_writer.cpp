@@ -0,0 +1,45 @@
+#include <buffered_file_writer.h>
+
+#include <cstring>
+
+namespace geom {
+
+BufferedFileWriter::BufferedFileWriter(const std::string& path) :
+    file_(std::fopen(path.c_str(), "wb")),
+    failed_(!file_) {}
+
+BufferedFileWriter::~BufferedFileWriter() {
+  Close();
+}
+
+bool BufferedFileWriter::IsOpen() const {
+  return file_ != nullptr;
+}
+
+void BufferedFileWriter::Write(const void* data, size_t size) {
+  if (used_ + size > kBufferSize)
+    Flush();
+  if (size > kBufferSize) {
+    if (file_ && std::fwrite(data, 1, size, file_) != size)
+      failed_ = true;
+    return;
+  }
+  std::memcpy(buffer_ + used_, data, size);
+  used_ += size;
+}
+
+bool BufferedFileWriter::Close() {
+  Flush();
+  if (file_ && std::fclose(file_) != 0)
+    failed_ = true;
+  file_ = nullptr;
+  return !failed_;
+}
+
+void BufferedFileWriter::Flush() {
+  if (file_ && used_ && std::fwrite(buffer_, 1, used_, file_) != used_)
+    failed_ = true;
+  used_ = 0;
+}
+
+}  // geom
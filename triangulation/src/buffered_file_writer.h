@@ -0,0 +1,38 @@
+#ifndef BUFFERED_FILE_WRITER_H
+#define BUFFERED_FILE_WRITER_H
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+
+namespace geom {
+
+// Appends fixed size records to a file through a buffer
+class BufferedFileWriter {
+ public:
+  explicit BufferedFileWriter(const std::string& path);
+  ~BufferedFileWriter();
+
+  BufferedFileWriter(const BufferedFileWriter&) = delete;
+  BufferedFileWriter& operator=(const BufferedFileWriter&) = delete;
+
+  // False if the file can't be opened or is closed already
+  bool IsOpen() const;
+  void Write(const void* data, size_t size);
+  // False if the file can't be opened or any write failed
+  bool Close();
+
+ private:
+  static constexpr size_t kBufferSize = 1 << 16;
+
+  void Flush();
+
+  std::FILE* file_;
+  bool failed_;
+  size_t used_ = 0;
+  char buffer_[kBufferSize];
+};
+
+}  // geom
+
+#endif  // BUFFERED_FILE_WRITER_H
@@ -1,160 +1,249 @@
 #include <dcel_polygon2d.h>
 
-#include <cmath>
-#include <unordered_map>
+#include <algorithm>
 #include <utility>
 
 namespace geom {
 
 namespace {
 
+constexpr uint32_t kNoIndex = UINT32_MAX;
+
 bool IsPointLeftToSegment(const Segment2D& segment, const Point2D& point) {
-  const Vector2D v = {segment.a, point};
-  const Vector2D u = {segment.a, segment.b};
-  return MoreThenPiAngle2D(v, u);
+  return Orient2D(segment.a, segment.b, point) > 0;
 }
 
 }  // namespace
 
-DcelPolygon2D::HalfEdge::HalfEdge(const Vertex* origin, const Vector2D& v) :
-    origin(origin), angle(std::atan2(v.y, v.x)) {}
+DcelPolygon2D::HalfEdge::HalfEdge(Index origin, const Vector2D& v) :
+    origin(origin), direction(v),
+    prev(kNoIndex), next(kNoIndex), twin(kNoIndex), face(kNoIndex) {}
+
+void DcelPolygon2D::EdgeFan::Insert(size_t pos, Index edge) {
+  if (size_ < kInlineSize) {
+    std::copy_backward(inline_ + pos, inline_ + size_, inline_ + size_ + 1);
+    inline_[pos] = edge;
+  } else {
+    if (size_ == kInlineSize)
+      overflow_.assign(inline_, inline_ + kInlineSize);
+    overflow_.insert(overflow_.begin() + pos, edge);
+  }
+  size_++;
+}
 
-std::tuple<const DcelPolygon2D::HalfEdge*, const DcelPolygon2D::HalfEdge*>
-    DcelPolygon2D::Vertex::GetNeighbourHalfEdges(
-    const HalfEdge* edge) const {
-  auto right = edges.upper_bound(edge);
-  if (right == edges.end())
-    right = edges.begin();
+DcelPolygon2D::Index DcelPolygon2D::AddVertex(const Point2D& point,
+                                              uint32_t id) {
+  auto [it, inserted] = vertex_indices_.emplace(
+      point, static_cast<Index>(vertices_.size()));
+  if (inserted)
+    vertices_.push_back(Vertex(point, id, memory_));
+  return it->second;
+}
 
-  auto left = edges.upper_bound(edge);
-  if (left == edges.begin())
-    left = edges.end();
-  left--;
-  
-  return std::make_tuple(*left, *right);
+DcelPolygon2D::Index DcelPolygon2D::AddIntersectionVertex(
+    const Point2D& point) {
+  const size_t size = vertices_.size();
+  const Index vertex = AddVertex(point, kAddedVertexId | added_vertices_);
+  if (vertices_.size() != size)
+    added_vertices_++;
+  return vertex;
 }
 
-bool operator<(const DcelPolygon2D::Vertex& lhv,
-               const DcelPolygon2D::Vertex& rhv) {
-  return lhv.point < rhv.point;
+std::optional<DcelPolygon2D::Index> DcelPolygon2D::FindVertex(
+    const Point2D& point) const {
+  const auto it = vertex_indices_.find(point);
+  if (it == vertex_indices_.end())
+    return {};
+  return it->second;
 }
 
-bool operator==(const DcelPolygon2D::Face& lhf,
-                const DcelPolygon2D::Face& rhf) {
-  return lhf.edge == rhf.edge;
+DcelPolygon2D::Index DcelPolygon2D::AddHalfEdge(Index origin,
+                                                const Vector2D& v) {
+  half_edges_.push_back(HalfEdge(origin, v));
+  return static_cast<Index>(half_edges_.size() - 1);
 }
 
-bool operator!=(const DcelPolygon2D::Face& lhf,
-                const DcelPolygon2D::Face& rhf) {
-  return !(lhf == rhf);
+const DcelPolygon2D::Index* DcelPolygon2D::LowerBound(
+    const EdgeFan& edges, const Vector2D& direction) const {
+  return std::lower_bound(edges.begin(), edges.end(), direction,
+      [&](Index edge, const Vector2D& direction) {
+        return PolarAngleLess(half_edges_[edge].direction, direction);
+      });
 }
 
-DcelPolygon2D::DcelPolygon2D(const Polygon2D& polygon2D) {
-  std::unordered_map<const Polygon2D::Vertex*, const Vertex*> pnt_to_vertex;
-  std::unordered_map<const Polygon2D::Vertex*, const HalfEdge*>
-      pnt_to_edge_forward;
+const DcelPolygon2D::Index* DcelPolygon2D::UpperBound(
+    const EdgeFan& edges, const Vector2D& direction) const {
+  return std::upper_bound(edges.begin(), edges.end(), direction,
+      [&](const Vector2D& direction, Index edge) {
+        return PolarAngleLess(direction, half_edges_[edge].direction);
+      });
+}
 
-  const Polygon2D::Vertex* current = polygon2D.GetAnyVertex();
-  for (size_t i = 0; i < polygon2D.Size(); i++) {
-    const Polygon2D::Vertex* next = current->next;
+// Edges with the same direction are not added (as std::set does)
+void DcelPolygon2D::AddToFan(Index edge) {
+  const Vector2D& direction = half_edges_[edge].direction;
+  EdgeFan& edges = vertices_[half_edges_[edge].origin].edges;
+  const Index* pos = LowerBound(edges, direction);
+  if (pos != edges.end() &&
+      !PolarAngleLess(direction, half_edges_[*pos].direction))
+    return;
+  edges.Insert(pos - edges.begin(), edge);
+}
 
-    const Vertex* vertex = &*vertices_.insert(Vertex(current->point)).first;
-    pnt_to_vertex[current] = vertex;
+std::tuple<DcelPolygon2D::Index, DcelPolygon2D::Index>
+    DcelPolygon2D::GetNeighbourHalfEdges(Index edge) const {
+  const EdgeFan& edges = vertices_[half_edges_[edge].origin].edges;
+  const Index* upper = UpperBound(edges, half_edges_[edge].direction);
 
-    half_edges_.push_back(HalfEdge(vertex, {current->point, next->point}));
-    const HalfEdge* edge = &half_edges_.back();
-    vertex->edges.insert(edge);
-    pnt_to_edge_forward[current] = edge;
+  const Index* right = upper;
+  if (right == edges.end())
+    right = edges.begin();
 
-    current = next;
-  }
+  const Index* left = upper;
+  if (left == edges.begin())
+    left = edges.end();
+  left--;
 
-  for (size_t i = 0; i < polygon2D.Size(); i++) {
-    const Polygon2D::Vertex* prev = current->prev;
-    const Polygon2D::Vertex* next = current->next;
+  return std::make_tuple(*left, *right);
+}
 
-    const HalfEdge* edge = pnt_to_edge_forward[current];
-    edge->prev = pnt_to_edge_forward[prev];
-    edge->next = pnt_to_edge_forward[next];
+DcelPolygon2D::DcelPolygon2D(const Polygon2D& polygon2D,
+                             std::pmr::memory_resource* memory,
+                             TriangulationStats* stats) :
+    DcelPolygon2D(polygon2D, std::pmr::vector<Polygon2D>(memory), memory,
+                  stats) {}
+
+// Vertices of all the rings v[0..n) (polygon ring first) are turned into
+// forward half-edges [0, n) (v[i] -> next of v[i] in its ring) and
+// backward half-edges [n, 2n) (next of v[i] -> v[i])
+// Forward half-edges of ring r bound face r and backward ones face R + r,
+// so faces inside holes are [R + 1, 2R)
+DcelPolygon2D::DcelPolygon2D(const Polygon2D& polygon2D,
+                             const std::pmr::vector<Polygon2D>& holes,
+                             std::pmr::memory_resource* memory,
+                             TriangulationStats* stats,
+                             size_t edges_to_insert) :
+    memory_(memory), stats_(stats), outer_edge_(kNoIndex), faces_(memory),
+    face_parents_(memory), faces_stale_(false), half_edges_(memory),
+    vertices_(memory), vertex_indices_(memory), added_vertices_(0) {
+  size_t size = polygon2D.Size();
+  for (const Polygon2D& hole : holes)
+    size += hole.Size();
+  const Index n = static_cast<Index>(size);
+  vertices_.reserve(n);
+  vertex_indices_.reserve(n);
+  half_edges_.reserve(2 * (n + edges_to_insert));
+
+  // Vertex index and positions of the ring neighbours of v[i]
+  std::pmr::vector<Index> ring(memory_);
+  std::pmr::vector<Index> prev_i(memory_);
+  std::pmr::vector<Index> next_i(memory_);
+  std::pmr::vector<Index> ring_begins(memory_);
+  ring.reserve(n);
+  prev_i.reserve(n);
+  next_i.reserve(n);
+  auto AddRing = [&](const Polygon2D& ring_polygon) {
+    const Index begin = static_cast<Index>(ring.size());
+    const Index end = begin + static_cast<Index>(ring_polygon.Size());
+    if (begin == end)
+      return;
+    ring_begins.push_back(begin);
+    for (Index i = begin; i < end; i++) {
+      ring.push_back(AddVertex(ring_polygon.Point(i - begin),
+                               ring_polygon.Id(i - begin)));
+      prev_i.push_back(i > begin ? i - 1 : end - 1);
+      next_i.push_back(i + 1 < end ? i + 1 : begin);
+    }
+  };
+  AddRing(polygon2D);
+  for (const Polygon2D& hole : holes)
+    AddRing(hole);
 
-    current = next;
+  for (Index i = 0; i < n; i++) {
+    const Index u = ring[i], v = ring[next_i[i]];
+    AddHalfEdge(u, {vertices_[u].point, vertices_[v].point});
+  }
+  for (Index i = 0; i < n; i++) {
+    const Index u = ring[i], v = ring[next_i[i]];
+    AddHalfEdge(v, {vertices_[v].point, vertices_[u].point});
   }
 
-  faces_.push_back(Face(pnt_to_edge_forward[current]));
-
-  std::unordered_map<const Polygon2D::Vertex*, const HalfEdge*>
-      pnt_to_edge_back;
-  for (size_t i = 0; i < polygon2D.Size(); i++) {
-    const Polygon2D::Vertex* next = current->next;
+  for (Index i = 0; i < n; i++) {
+    HalfEdge& forward = half_edges_[i];
+    forward.prev = prev_i[i];
+    forward.next = next_i[i];
+    forward.twin = n + i;
 
-    const Vertex* vertex = pnt_to_vertex[next];
+    HalfEdge& backward = half_edges_[n + i];
+    backward.prev = n + next_i[i];
+    backward.next = n + prev_i[i];
+    backward.twin = i;
+  }
 
-    half_edges_.push_back(HalfEdge(vertex, {next->point, current->point}));
-    const HalfEdge* edge = &half_edges_.back();
-    vertex->edges.insert(edge);
+  for (Index i = 0; i < 2 * n; i++)
+    AddToFan(i);
+
+  const Index rings = static_cast<Index>(ring_begins.size());
+  faces_.reserve(2 * rings + edges_to_insert);
+  face_parents_.reserve(2 * rings + edges_to_insert);
+  for (const Index begin : ring_begins)
+    AddFace(begin);
+  for (const Index begin : ring_begins)
+    AddFace(n + begin);
+  hole_faces_begin_ = rings + 1;
+  hole_faces_end_ = 2 * rings;
+
+  // No other vertex is below it or to the left on the same line,
+  // so all its half-edges are in the upper half-plane
+  // and the unbounded face is right to the first one
+  const auto lowest = std::min_element(vertices_.begin(), vertices_.end(),
+      [](const Vertex& lhs, const Vertex& rhs) {
+        return std::tie(lhs.point.y, lhs.point.x) <
+               std::tie(rhs.point.y, rhs.point.x);
+      });
+  if (lowest != vertices_.end())
+    outer_edge_ = *lowest->edges.begin();
+}
 
-    pnt_to_edge_forward[current]->twin = edge;
-    edge->twin = pnt_to_edge_forward[current];
+void DcelPolygon2D::InsertEdge(const Segment2D& edge) {
+  if (stats_)
+    stats_->inserted_edges++;
+  const std::optional<Index> u_opt = FindVertex(edge.a);
+  const std::optional<Index> v_opt = FindVertex(edge.b);
+  if (!u_opt || !v_opt)
+    return;
 
-    pnt_to_edge_back[next] = edge;
+  const Index u = u_opt.value();
+  const Index v = v_opt.value();
+  if (faces_stale_)
+    RebuildFaces();
 
-    current = next;
-  }
+  const Index uv_edge = AddHalfEdge(u, {edge.a, edge.b});
+  const Index vu_edge = AddHalfEdge(v, {edge.b, edge.a});
 
-  for (size_t i = 0; i < polygon2D.Size(); i++) {
-    const Polygon2D::Vertex* prev = current->prev;
-    const Polygon2D::Vertex* next = current->next;
+  half_edges_[uv_edge].twin = vu_edge;
+  half_edges_[vu_edge].twin = uv_edge;
 
-    const HalfEdge* edge = pnt_to_edge_back[current];
-    edge->prev = pnt_to_edge_back[next];
-    edge->next = pnt_to_edge_back[prev];
+  Index u_left, u_right, v_left, v_right;
+  std::tie(u_left, u_right) = GetNeighbourHalfEdges(uv_edge);
+  std::tie(v_left, v_right) = GetNeighbourHalfEdges(vu_edge);
+  const Index u_face = half_edges_[u_right].face;
+  const Index v_face = half_edges_[v_right].face;
 
-    current = next;
-  }
+  half_edges_[half_edges_[u_left].twin].next = uv_edge;
+  half_edges_[uv_edge].prev = half_edges_[u_left].twin;
+  half_edges_[uv_edge].next = v_right;
+  half_edges_[v_right].prev = uv_edge;
 
-  Face external_face(pnt_to_edge_forward[current]->twin);
-  faces_.push_back(external_face);
-}
+  half_edges_[half_edges_[v_left].twin].next = vu_edge;
+  half_edges_[vu_edge].prev = half_edges_[v_left].twin;
+  half_edges_[vu_edge].next = u_right;
+  half_edges_[u_right].prev = vu_edge;
 
-void DcelPolygon2D::InsertEdge(const Segment2D& edge) {
-  auto u_it = vertices_.find(Vertex(edge.a));
-  auto v_it = vertices_.find(Vertex(edge.b));
-  if (u_it == vertices_.end() || v_it == vertices_.end())
-    return;
+  AddToFan(uv_edge);
+  AddToFan(vu_edge);
 
-  const Vertex* u = &*u_it;
-  const Vertex* v = &*v_it;
-
-  half_edges_.push_back(HalfEdge(u, {edge.a, edge.b}));
-  const HalfEdge* uv_edge = &half_edges_.back();
-  half_edges_.push_back(HalfEdge(v, {edge.b, edge.a}));
-  const HalfEdge* vu_edge = &half_edges_.back();
-
-  uv_edge->twin = vu_edge;
-  vu_edge->twin = uv_edge;
-
-  const HalfEdge* u_left;
-  const HalfEdge* u_right;
-  const HalfEdge* v_left;
-  const HalfEdge* v_right;
-  std::tie(u_left, u_right) = u->GetNeighbourHalfEdges(uv_edge);
-  std::tie(v_left, v_right) = v->GetNeighbourHalfEdges(vu_edge);
-  
-  u_left->twin->next = uv_edge;
-  uv_edge->prev = u_left->twin;
-  uv_edge->next = v_right;
-  v_right->prev = uv_edge;
-
-  v_left->twin->next = vu_edge;
-  vu_edge->prev = v_left->twin;
-  vu_edge->next = u_right;
-  u_right->prev = vu_edge;
-
-  u->edges.insert(uv_edge);
-  v->edges.insert(vu_edge);
-
-  faces_.push_back(Face(vu_edge));
-  faces_.push_back(Face(uv_edge));
+  UpdateFaces(uv_edge, vu_edge, u_face, v_face);
 }
 
 // a1     b2
@@ -164,8 +253,24 @@ void DcelPolygon2D::InsertEdge(const Segment2D& edge) {
 //    / \    
 //   /   \  
 // b1     a2
+// An end of one segment touching the other one inside
+// only splits the other one
 void DcelPolygon2D::ResolveIntersection(const Segment2D& a,
                                         const Segment2D& b) {
+  const std::optional<Point2D> intersection_opt = IntersectionPoint(a, b);
+  if (!intersection_opt)
+    return;
+  const Point2D intersection_point = intersection_opt.value();
+  const bool on_a_end = intersection_point == a.a ||
+                        intersection_point == a.b;
+  const bool on_b_end = intersection_point == b.a ||
+                        intersection_point == b.b;
+  if (on_a_end || on_b_end) {
+    if (on_a_end != on_b_end)
+      SplitEdge(on_a_end ? b : a, intersection_point);
+    return;
+  }
+
   const Point2D a1_pnt = a.a;
   const Point2D a2_pnt = a.b;
   Point2D b1_pnt = b.a;
@@ -173,146 +278,250 @@ void DcelPolygon2D::ResolveIntersection(const Segment2D& a,
   if (IsPointLeftToSegment(a, b.a))
     std::swap(b1_pnt, b2_pnt);
 
-  const std::optional<Point2D> intersection_opt = IntersectionPoint(a, b);
-  const auto a1_it = vertices_.find(Vertex(a1_pnt));
-  const auto a2_it = vertices_.find(Vertex(a2_pnt));
-  const auto b1_it = vertices_.find(Vertex(b1_pnt));
-  const auto b2_it = vertices_.find(Vertex(b2_pnt));
-  const auto vertices_end = vertices_.end();
-  if (a1_it == vertices_end || a2_it == vertices_end ||
-      b1_it == vertices_end || b2_it == vertices_end || !intersection_opt)
+  const std::optional<Index> a1 = FindVertex(a1_pnt);
+  const std::optional<Index> a2 = FindVertex(a2_pnt);
+  const std::optional<Index> b1 = FindVertex(b1_pnt);
+  const std::optional<Index> b2 = FindVertex(b2_pnt);
+  if (!a1 || !a2 || !b1 || !b2)
     return;
-  const Vertex* a1 = &*a1_it;
-  const Vertex* a2 = &*a2_it;
-  const Vertex* b1 = &*b1_it;
-  const Vertex* b2 = &*b2_it;
-  const std::optional<const HalfEdge*> a1a2he_opt = GetHalfEdge(a1, a2);
-  const std::optional<const HalfEdge*> b1b2he_opt = GetHalfEdge(b1, b2);
+  const std::optional<Index> a1a2he_opt = GetHalfEdge(*a1, *a2);
+  const std::optional<Index> b1b2he_opt = GetHalfEdge(*b1, *b2);
   if (!a1a2he_opt || !b1b2he_opt)
     return;
-  const HalfEdge* a1a2he = a1a2he_opt.value();
-  const HalfEdge* a2a1he = a1a2he->twin;
-  const HalfEdge* b1b2he = b1b2he_opt.value();
-  const HalfEdge* b2b1he = b1b2he->twin;
+  const Index a1a2he = a1a2he_opt.value();
+  const Index a2a1he = half_edges_[a1a2he].twin;
+  const Index b1b2he = b1b2he_opt.value();
+  const Index b2b1he = half_edges_[b1b2he].twin;
 
-  const Point2D intersection_point = intersection_opt.value();
-  auto existing_intersection_vertex_it =
-      vertices_.find(Vertex(intersection_point));
-  const Vertex* intersection;
-  if (existing_intersection_vertex_it != vertices_.end())
-    intersection = &*existing_intersection_vertex_it;
-  else
-    intersection = &*vertices_.insert(Vertex(intersection_point)).first;
-
-  half_edges_.push_back(HalfEdge(intersection, {intersection->point, a1_pnt}));
-  const HalfEdge* inta1he = &half_edges_.back();
-  half_edges_.push_back(HalfEdge(intersection, {intersection->point, a2_pnt}));
-  const HalfEdge* inta2he = &half_edges_.back();
-  half_edges_.push_back(HalfEdge(intersection, {intersection->point, b1_pnt}));
-  const HalfEdge* intb1he = &half_edges_.back();
-  half_edges_.push_back(HalfEdge(intersection, {intersection->point, b2_pnt}));
-  const HalfEdge* intb2he = &half_edges_.back();
-
-  intersection->edges.insert(inta1he);
-  intersection->edges.insert(inta2he);
-  intersection->edges.insert(intb1he);
-  intersection->edges.insert(intb2he);
-
-  inta1he->twin = a1a2he;
-  a1a2he->twin = inta1he;
-
-  inta2he->twin = a2a1he;
-  a2a1he->twin = inta2he;
-
-  intb1he->twin = b1b2he;
-  b1b2he->twin = intb1he;
-
-  intb2he->twin = b2b1he;
-  b2b1he->twin = intb2he;
-
-  inta1he->next = a2a1he->next;
-  inta2he->next = a1a2he->next;
-  intb1he->next = b2b1he->next;
-  intb2he->next = b1b2he->next;
-
-  inta1he->prev = b2b1he;
-  b2b1he->next = inta1he;
-
-  inta2he->prev = b1b2he;
-  b1b2he->next = inta2he;
-
-  intb1he->prev = a1a2he;
-  a1a2he->next = intb1he;
-
-  intb2he->prev = a2a1he;
-  a2a1he->next = intb2he;
-
-  inta1he->next->prev = inta1he;
-  inta2he->next->prev = inta2he;
-  intb1he->next->prev = intb1he;
-  intb2he->next->prev = intb2he;
-
-  faces_.push_back(Face(inta1he));
-  faces_.push_back(Face(inta2he));
-  faces_.push_back(Face(intb1he));
-  faces_.push_back(Face(intb2he));
+  const Index intersection = AddIntersectionVertex(intersection_point);
+
+  const Index inta1he = AddHalfEdge(intersection, {intersection_point, a1_pnt});
+  const Index inta2he = AddHalfEdge(intersection, {intersection_point, a2_pnt});
+  const Index intb1he = AddHalfEdge(intersection, {intersection_point, b1_pnt});
+  const Index intb2he = AddHalfEdge(intersection, {intersection_point, b2_pnt});
+
+  AddToFan(inta1he);
+  AddToFan(inta2he);
+  AddToFan(intb1he);
+  AddToFan(intb2he);
+
+  HalfEdge* he = half_edges_.data();
+
+  he[inta1he].twin = a1a2he;
+  he[a1a2he].twin = inta1he;
+
+  he[inta2he].twin = a2a1he;
+  he[a2a1he].twin = inta2he;
+
+  he[intb1he].twin = b1b2he;
+  he[b1b2he].twin = intb1he;
+
+  he[intb2he].twin = b2b1he;
+  he[b2b1he].twin = intb2he;
+
+  he[inta1he].next = he[a2a1he].next;
+  he[inta2he].next = he[a1a2he].next;
+  he[intb1he].next = he[b2b1he].next;
+  he[intb2he].next = he[b1b2he].next;
+
+  he[inta1he].prev = b2b1he;
+  he[b2b1he].next = inta1he;
+
+  he[inta2he].prev = b1b2he;
+  he[b1b2he].next = inta2he;
+
+  he[intb1he].prev = a1a2he;
+  he[a1a2he].next = intb1he;
+
+  he[intb2he].prev = a2a1he;
+  he[a2a1he].next = intb2he;
+
+  he[he[inta1he].next].prev = inta1he;
+  he[he[inta2he].next].prev = inta2he;
+  he[he[intb1he].next].prev = intb1he;
+  he[he[intb2he].next].prev = intb2he;
+
+  faces_stale_ = true;
 }
 
-std::list<Polygon2D> DcelPolygon2D::GetPolygons() const {
-  struct PolygonWithArea {
-    long double area;
-    std::vector<Point2D> polygon_v;
+// a1 -> a2 becomes a1 -> middle -> a2,
+// new half-edges are linked at the middle vertex as InsertEdge does
+void DcelPolygon2D::SplitEdge(const Segment2D& edge, const Point2D& point) {
+  const std::optional<Index> a1 = FindVertex(edge.a);
+  const std::optional<Index> a2 = FindVertex(edge.b);
+  const std::optional<Index> middle = FindVertex(point);
+  if (!a1 || !a2 || !middle)
+    return;
+  const std::optional<Index> a1a2he_opt = GetHalfEdge(*a1, *a2);
+  if (!a1a2he_opt)
+    return;
+  const Index a1a2he = a1a2he_opt.value();
+  const Index a2a1he = half_edges_[a1a2he].twin;
 
-    PolygonWithArea(long double area, std::vector<Point2D>&& polygon_v) :
-        area(area), polygon_v(std::forward<std::vector<Point2D>>(polygon_v)) {}
-  };
+  const Index middlea1he = AddHalfEdge(*middle, {point, edge.a});
+  const Index middlea2he = AddHalfEdge(*middle, {point, edge.b});
 
-  std::set<const HalfEdge*> visited;
-  std::list<PolygonWithArea> res_polygons;
-  long double max_area = 0;
-  for (const Face& face : faces_) {
-    const HalfEdge* start_edge = face.edge;
-    if (visited.count(start_edge))
-      continue;
-    std::vector<Point2D> polygon_vector;
-    const HalfEdge* edge = face.edge;
-    long double area = 0;
-    do {
-      const Point2D current_pnt = edge->origin->point;
-      const Point2D next_pnt = edge->next->origin->point;
-      polygon_vector.push_back(edge->origin->point);
-      visited.insert(edge);
-
-      area += (next_pnt.x - current_pnt.x) * (next_pnt.y + current_pnt.y);
-      edge = edge->next;
-    } while (edge != start_edge);
-
-    area = std::fabs(area);
-    max_area = std::max(max_area, area);
-    res_polygons.push_back({area, std::move(polygon_vector)});
+  HalfEdge* he = half_edges_.data();
+
+  he[middlea1he].twin = a1a2he;
+  he[a1a2he].twin = middlea1he;
+
+  he[middlea2he].twin = a2a1he;
+  he[a2a1he].twin = middlea2he;
+
+  he[middlea1he].next = he[a2a1he].next;
+  he[middlea2he].next = he[a1a2he].next;
+  he[he[middlea1he].next].prev = middlea1he;
+  he[he[middlea2he].next].prev = middlea2he;
+
+  for (const Index middle_edge : {middlea1he, middlea2he}) {
+    Index left, right;
+    std::tie(left, right) = GetNeighbourHalfEdges(middle_edge);
+    const Index twin = he[middle_edge].twin;
+
+    he[he[left].twin].next = middle_edge;
+    he[middle_edge].prev = he[left].twin;
+    he[twin].next = right;
+    he[right].prev = twin;
+
+    AddToFan(middle_edge);
   }
 
-  std::list<Polygon2D> res;
-  bool external_exclided = false;
-  for (const PolygonWithArea& res_polygon : res_polygons)
-    if (res_polygon.area != max_area || external_exclided)
-      res.push_back(Polygon2D(res_polygon.polygon_v));
-    else
-      external_exclided = true;
+  faces_stale_ = true;
+}
 
+// Every bounded face has its one ring with the face on the right,
+// so the rings are already clockwise
+std::pmr::list<Polygon2D> DcelPolygon2D::GetPolygons() {
+  std::pmr::list<Polygon2D> res(memory_);
+  ConsumePolygons([&](Polygon2D&& polygon) {
+    res.push_back(std::move(polygon));
+  });
   return res;
 }
 
-std::optional<const DcelPolygon2D::HalfEdge*> DcelPolygon2D::GetHalfEdge(
-    const Vertex* a, const Vertex* b) const {
-  const HalfEdge half_edge_for_search = {a, {a->point, b->point}};
-  const auto half_edge_it = a->edges.lower_bound(&half_edge_for_search);
-  if (half_edge_it == a->edges.end())
-    return {};
-  const HalfEdge* half_edge = *half_edge_it;
-  if (half_edge->next->origin == b)
-    return half_edge;
+void DcelPolygon2D::ConsumePolygons(
+    const std::function<void(Polygon2D&&)>& consume) {
+  if (outer_edge_ == kNoIndex)
+    return;
+  if (faces_stale_)
+    RebuildFaces();
+
+  const Index outer_face = FindFace(half_edges_[outer_edge_].face);
+  std::pmr::vector<Point2D> ring(memory_);
+  std::pmr::vector<uint32_t> ring_ids(memory_);
+  for (Index face = 0; face < faces_.size(); face++) {
+    if (faces_[face] == kNoIndex || face == outer_face || IsHoleFace(face))
+      continue;
+    ring.clear();
+    ring_ids.clear();
+    Index edge = faces_[face];
+    do {
+      const Vertex& vertex = vertices_[half_edges_[edge].origin];
+      ring.push_back(vertex.point);
+      ring_ids.push_back(vertex.id);
+      edge = half_edges_[edge].next;
+    } while (edge != faces_[face]);
+    consume(Polygon2D::FromClockwiseRing(ring.data(),
+                                         ring.data() + ring.size(),
+                                         ring_ids.data(), memory_));
+  }
+}
+
+// Looked up by destination instead of direction:
+// a -> b may be a part of a longer half-edge after ResolveIntersection
+// so its direction is known only up to rounding of the intersection point
+std::optional<DcelPolygon2D::Index> DcelPolygon2D::GetHalfEdge(
+    Index a, Index b) const {
+  for (const Index half_edge : vertices_[a].edges)
+    if (half_edges_[half_edges_[half_edge].next].origin == b)
+      return half_edge;
   return {};
 }
 
+bool DcelPolygon2D::IsHoleFace(Index face) const {
+  return hole_faces_begin_ <= face && face < hole_faces_end_;
+}
+
+DcelPolygon2D::Index DcelPolygon2D::FindFace(Index face) {
+  while (face_parents_[face] != face) {
+    face_parents_[face] = face_parents_[face_parents_[face]];
+    face = face_parents_[face];
+  }
+  return face;
+}
+
+DcelPolygon2D::Index DcelPolygon2D::MergeFaces(Index a, Index b) {
+  a = FindFace(a);
+  b = FindFace(b);
+  if (a != b) {
+    face_parents_[b] = a;
+    faces_[b] = kNoIndex;
+  }
+  return a;
+}
+
+DcelPolygon2D::Index DcelPolygon2D::AddFace(Index edge) {
+  const Index face = static_cast<Index>(faces_.size());
+  faces_.push_back(edge);
+  face_parents_.push_back(face);
+  SetFace(edge, face);
+  return face;
+}
+
+void DcelPolygon2D::SetFace(Index edge, Index face) {
+  const Index start_edge = edge;
+  do {
+    half_edges_[edge].face = face;
+    edge = half_edges_[edge].next;
+  } while (edge != start_edge);
+}
+
+// Rings of the new half-edges are walked in lockstep
+// If a walk reaches the other new half-edge the edge has joined two rings
+// and their faces are merged
+// Otherwise the ring closed first gets a new face and the other one
+// keeps the old face, so only the shorter part of the split is relabeled
+void DcelPolygon2D::UpdateFaces(Index uv_edge, Index vu_edge,
+                                Index u_face, Index v_face) {
+  const Index face = MergeFaces(u_face, v_face);
+  half_edges_[uv_edge].face = face;
+  half_edges_[vu_edge].face = face;
+  Index uv_current = uv_edge;
+  Index vu_current = vu_edge;
+  while (true) {
+    uv_current = half_edges_[uv_current].next;
+    vu_current = half_edges_[vu_current].next;
+    if (uv_current == vu_edge || vu_current == uv_edge) {
+      faces_[face] = uv_edge;
+      return;
+    }
+    if (uv_current == uv_edge) {
+      faces_[face] = vu_edge;
+      AddFace(uv_edge);
+      return;
+    }
+    if (vu_current == vu_edge) {
+      faces_[face] = uv_edge;
+      AddFace(vu_edge);
+      return;
+    }
+  }
+}
+
+// Faces inside holes aren't touched by ResolveIntersection
+// and keep their ids, all the other ones are replaced by new faces
+void DcelPolygon2D::RebuildFaces() {
+  for (HalfEdge& half_edge : half_edges_)
+    if (half_edge.face != kNoIndex && !IsHoleFace(FindFace(half_edge.face)))
+      half_edge.face = kNoIndex;
+  for (Index face = 0; face < faces_.size(); face++)
+    if (!IsHoleFace(face))
+      faces_[face] = kNoIndex;
+  for (Index edge = 0; edge < half_edges_.size(); edge++)
+    if (half_edges_[edge].face == kNoIndex)
+      AddFace(edge);
+  faces_stale_ = false;
+}
+
 }  // geom
@@ -3,79 +3,151 @@
 
 #include <geom_utils.h>
 #include <polygon2d.h>
+#include <triangulation_stats.h>
 
+#include <cstdint>
+#include <functional>
 #include <list>
+#include <memory_resource>
 #include <optional>
-#include <set>
 #include <tuple>
+#include <unordered_map>
+#include <vector>
 
 namespace geom {
 
 // Doubly-connected edge list polygon representation
 // Used for inserting edges and decomposing polygons
+// Half-edges and vertices are stored in flat vectors
+// and reference each other by 32-bit indices
+// All the memory is taken from the given memory resource
+// Every half-edge keeps id of its face, the face is on its right side
+// Faces list is kept exact while edges are inserted:
+// only the shorter of the split parts is relabeled
+// and merged faces are joined by union-find over face ids
+// Faces split by ResolveIntersection are found again in one linear pass
+// when they are needed, since the split rings are long in the middle
+// of the sweep
+// Vertices keep ids of Polygon2D vertices (the first one of the vertices
+// at the same point), intersection vertices get new kAddedVertexId ids
 
 class DcelPolygon2D {
  public:
-  DcelPolygon2D(const Polygon2D& polygon2D);
-
-  // TODO: InsertEdge and ResolveIntersection create redundant faces
-  //   Asymptotically it's ok but it whould useful to find a way
-  //   to maintain the correct faces list all the time
+  // Counters of stats are updated when it's given
+  explicit DcelPolygon2D(const Polygon2D& polygon2D,
+                         std::pmr::memory_resource* memory =
+                             std::pmr::get_default_resource(),
+                         TriangulationStats* stats = nullptr);
+  // Holes (see Polygon2D::HoleFromRing) must lie inside the polygon
+  // without touching it and each other
+  // Faces inside holes aren't returned by GetPolygons
+  // Room is kept for edges_to_insert InsertEdge calls, so the half-edges
+  // aren't reallocated (and held twice) in the middle of a sweep
+  DcelPolygon2D(const Polygon2D& polygon2D,
+                const std::pmr::vector<Polygon2D>& holes,
+                std::pmr::memory_resource* memory =
+                    std::pmr::get_default_resource(),
+                TriangulationStats* stats = nullptr,
+                size_t edges_to_insert = 0);
 
   void InsertEdge(const Segment2D& edge);
   void ResolveIntersection(const Segment2D& a, const Segment2D& b);
-  std::list<Polygon2D> GetPolygons() const;
+  std::pmr::list<Polygon2D> GetPolygons();
+  // Same polygons in the same order, each one is handed to consume
+  // as soon as it's built, so they aren't kept all at once
+  void ConsumePolygons(const std::function<void(Polygon2D&&)>& consume);
 
  private:
-  struct Vertex;
+  using Index = uint32_t;
 
   struct HalfEdge {
-    const Vertex* origin;
-    const double angle;
-    mutable const HalfEdge* prev;
-    mutable const HalfEdge* next;
-    mutable const HalfEdge* twin;
-
-    HalfEdge(const Vertex* origin, const Vector2D& v);
+    Index origin;
+    Vector2D direction;
+    Index prev;
+    Index next;
+    Index twin;
+    Index face;
+
+    HalfEdge(Index origin, const Vector2D& v);
   };
 
-  struct Vertex {
-    struct HalfEdgeAngleComparator {
-      bool operator()(const HalfEdge* const& lhp,
-                      const HalfEdge* const& rhp) const {
-        if (DoubleEqual(lhp->angle, rhp->angle))
-          return false;
-        return lhp->angle < rhp->angle;
-      }
-    };
-
-    const Point2D point;
-    mutable std::set<const HalfEdge*, HalfEdgeAngleComparator> edges;
-
-    explicit Vertex(const Point2D& point) : point(point) {}
-
-    std::tuple<const HalfEdge*,  const HalfEdge*> GetNeighbourHalfEdges(
-        const HalfEdge* edge) const;
-  };
+  // Outgoing half-edges of a vertex sorted by polar angle of direction
+  // Kept inline since most of vertices have degree 2-4
+  class EdgeFan {
+   public:
+    explicit EdgeFan(std::pmr::memory_resource* memory) : overflow_(memory) {}
 
-  struct Face {
-    const HalfEdge* edge;
+    const Index* begin() const { return Data(); }
+    const Index* end() const { return Data() + size_; }
 
-    Face() {}
-    explicit Face(const HalfEdge* edge) : edge(edge) {}
-  };
+    void Insert(size_t pos, Index edge);
 
-  friend bool operator<(const Vertex& lhv, const Vertex& rhv);
+   private:
+    static constexpr size_t kInlineSize = 4;
 
-  friend bool operator==(const Face& lhf, const Face& rhf);
-  friend bool operator!=(const Face& lhf, const Face& rhf);
+    const Index* Data() const {
+      return size_ <= kInlineSize ? inline_ : overflow_.data();
+    }
 
-  std::optional<const HalfEdge*> GetHalfEdge(
-      const Vertex* a, const Vertex* b) const;
+    uint32_t size_ = 0;
+    Index inline_[kInlineSize] = {};
+    std::pmr::vector<Index> overflow_;
+  };
+
+  struct Vertex {
+    Point2D point;
+    uint32_t id;
+    EdgeFan edges;
+
+    Vertex(const Point2D& point, uint32_t id,
+           std::pmr::memory_resource* memory) :
+        point(point), id(id), edges(memory) {}
+  };
 
-  std::list<Face> faces_;
-  std::list<HalfEdge> half_edges_;
-  std::set<Vertex> vertices_;
+  Index AddVertex(const Point2D& point, uint32_t id);
+  // Rounded intersection point may be a vertex already
+  Index AddIntersectionVertex(const Point2D& point);
+  std::optional<Index> FindVertex(const Point2D& point) const;
+  Index AddHalfEdge(Index origin, const Vector2D& v);
+
+  const Index* LowerBound(const EdgeFan& edges,
+                          const Vector2D& direction) const;
+  const Index* UpperBound(const EdgeFan& edges,
+                          const Vector2D& direction) const;
+  void AddToFan(Index edge);
+  std::tuple<Index, Index> GetNeighbourHalfEdges(Index edge) const;
+
+  std::optional<Index> GetHalfEdge(Index a, Index b) const;
+  // The point is a vertex already
+  void SplitEdge(const Segment2D& edge, const Point2D& point);
+
+  bool IsHoleFace(Index face) const;
+  Index FindFace(Index face);
+  Index MergeFaces(Index a, Index b);
+  Index AddFace(Index edge);
+  void SetFace(Index edge, Index face);
+  // Updates faces after the new edge is linked in between u_face and v_face
+  void UpdateFaces(Index uv_edge, Index vu_edge, Index u_face, Index v_face);
+  void RebuildFaces();
+
+  std::pmr::memory_resource* memory_;
+  TriangulationStats* stats_;
+  // Faces inside holes, never changed after construction
+  Index hole_faces_begin_;
+  Index hole_faces_end_;
+  // Leaves the lowest vertex with the smallest polar angle,
+  // so the unbounded face is always on its right
+  Index outer_edge_;
+  // Any half-edge of the face, kNoIndex for merged faces
+  std::pmr::vector<Index> faces_;
+  // Union-find parents, a face is its own parent until it's merged
+  std::pmr::vector<Index> face_parents_;
+  // Set by ResolveIntersection until RebuildFaces
+  bool faces_stale_;
+  std::pmr::vector<HalfEdge> half_edges_;
+  std::pmr::vector<Vertex> vertices_;
+  std::pmr::unordered_map<Point2D, Index> vertex_indices_;
+  uint32_t added_vertices_;
 };
 
 }  // geom
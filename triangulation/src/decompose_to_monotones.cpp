@@ -2,99 +2,203 @@
 
 #include <dcel_polygon2d.h>
 #include <segments_on_y_sweep_line.h>
+#include <sweep_order.h>
 
 #include <algorithm>
-#include <unordered_map>
-#include <set>
+#include <cstdint>
+#include <optional>
+#include <utility>
 
 namespace geom {
 
+namespace {
+
+constexpr uint32_t kNoHelper = UINT32_MAX;
+
+// Vertices of the polygon and its holes numbered one ring after another
+class SweepVertices {
+ public:
+  SweepVertices(const Polygon2D& polygon,
+                const std::pmr::vector<Polygon2D>& holes,
+                std::pmr::memory_resource* memory) :
+      x_(memory), y_(memory), types_(memory), ring_begins_(memory),
+      ring_ends_(memory) {
+    AddRing(polygon);
+    for (const Polygon2D& hole : holes)
+      AddRing(hole);
+  }
+
+  uint32_t Size() const { return static_cast<uint32_t>(x_.size()); }
+  Point2D Point(uint32_t vertex) const { return {x_[vertex], y_[vertex]}; }
+  Polygon2D::VertexType Type(uint32_t vertex) const { return types_[vertex]; }
+  uint32_t Next(uint32_t vertex) const {
+    return vertex + 1 == ring_ends_[vertex] ? ring_begins_[vertex]
+                                            : vertex + 1;
+  }
+  uint32_t Prev(uint32_t vertex) const {
+    return vertex == ring_begins_[vertex] ? ring_ends_[vertex] - 1
+                                          : vertex - 1;
+  }
+
+  const double* X() const { return x_.data(); }
+  const double* Y() const { return y_.data(); }
+  const Polygon2D::VertexType* Types() const { return types_.data(); }
+
+ private:
+  void AddRing(const Polygon2D& ring) {
+    const uint32_t begin = Size();
+    const uint32_t end = begin + static_cast<uint32_t>(ring.Size());
+    x_.insert(x_.end(), ring.X(), ring.X() + ring.Size());
+    y_.insert(y_.end(), ring.Y(), ring.Y() + ring.Size());
+    types_.insert(types_.end(), ring.Types(), ring.Types() + ring.Size());
+    ring_begins_.resize(end, begin);
+    ring_ends_.resize(end, end);
+  }
+
+  std::pmr::vector<double> x_;
+  std::pmr::vector<double> y_;
+  std::pmr::vector<Polygon2D::VertexType> types_;
+  // Bounds of the ring of every vertex
+  std::pmr::vector<uint32_t> ring_begins_;
+  std::pmr::vector<uint32_t> ring_ends_;
+};
+
 // Decomposing to y-montones is quite complicated
 // (Probably implementation is messy)
 // Please check the link in triangulation.cpp to get some understanding
-std::list<Polygon2D> DecomposeToYMonotones(
-    const std::vector<Point2D>& polygon_v) {
-  const Polygon2D polygon(polygon_v);
-  DcelPolygon2D dcel_polygon(polygon);
-  std::vector<const Polygon2D::Vertex*> vertices = AsVertexVector(polygon);
-  std::sort(vertices.rbegin(), vertices.rend(), YFirstVertexComparator());
-  SegmentsOnYSweepLine left_edges;
-  std::unordered_map<Segment2D, const Polygon2D::Vertex*> y_min_vertices;
-  for (const Polygon2D::Vertex* vertex : vertices) {
-    SegmentsOnYSweepLine::SetY(vertex->point.y);
-    switch (vertex->type) {
-      case Polygon2D::START: {
-        const Segment2D prev_edge = {vertex->point, vertex->prev->point};
-        left_edges.Add(prev_edge);
-        y_min_vertices[prev_edge] = vertex;
+// Diagonals which split the polygon to y-monotones,
+// sweep state is freed on return
+void InsertDiagonals(const Polygon2D& polygon,
+                     const std::pmr::vector<Polygon2D>& holes,
+                     std::pmr::memory_resource* memory,
+                     DcelPolygon2D* dcel_polygon) {
+  const SweepVertices sweep_vertices(polygon, holes, memory);
+  const std::pmr::vector<uint32_t> vertices =
+      SweepOrder(sweep_vertices.X(), sweep_vertices.Y(),
+                 sweep_vertices.Types(), sweep_vertices.Size(), memory);
+  // Left edges on the sweep line are tagged by the numbers of the edges,
+  // edge i goes from vertex i to the next one,
+  // so on the left chain it ends at its start vertex
+  SegmentsOnYSweepLine left_edges(memory);
+  // Lowest vertex seen above every edge (or the upper end of the edge)
+  std::pmr::vector<uint32_t> helpers(sweep_vertices.Size(), kNoHelper,
+                                     memory);
+  auto Point = [&](uint32_t vertex) { return sweep_vertices.Point(vertex); };
+  auto ConnectToMergeHelper = [&](uint32_t vertex, uint32_t edge) {
+    const uint32_t helper = helpers[edge];
+    if (helper != kNoHelper && sweep_vertices.Type(helper) == Polygon2D::MERGE)
+      dcel_polygon->InsertEdge({Point(vertex), Point(helper)});
+  };
+  // Edge going down from the vertex to the previous one
+  auto AddLeftEdge = [&](uint32_t vertex) {
+    const uint32_t edge = sweep_vertices.Prev(vertex);
+    left_edges.Add({Point(vertex), Point(edge)}, edge);
+    helpers[edge] = vertex;
+  };
+  // Edge coming down to the vertex from the next one
+  auto RemoveLeftEdge = [&](uint32_t vertex) {
+    ConnectToMergeHelper(vertex, vertex);
+    left_edges.Remove({Point(sweep_vertices.Next(vertex)), Point(vertex)});
+  };
+  for (const uint32_t vertex : vertices) {
+    const Point2D point = Point(vertex);
+    left_edges.SetY(point.y);
+    switch (sweep_vertices.Type(vertex)) {
+      case Polygon2D::START:
+        AddLeftEdge(vertex);
         break;
-      }
-      case Polygon2D::END: {
-        const Segment2D next_edge = {vertex->next->point, vertex->point};
-        const Polygon2D::Vertex* next_y_min_vertex = y_min_vertices[next_edge];
-        if (next_y_min_vertex->type == Polygon2D::MERGE)
-          dcel_polygon.InsertEdge({vertex->point, next_y_min_vertex->point});
-        left_edges.Remove(next_edge);
+      case Polygon2D::END:
+        RemoveLeftEdge(vertex);
         break;
-      }
       case Polygon2D::SPLIT: {
-        const Segment2D prev_edge = {vertex->point, vertex->prev->point};
-        const std::optional<Segment2D> left_edge =
-          left_edges.FirstLeft(vertex->point);
-        left_edges.Add(prev_edge);
-        y_min_vertices[prev_edge] = vertex;
+        const std::optional<uint32_t> left_edge =
+            left_edges.FirstLeftTag(point);
+        AddLeftEdge(vertex);
         if (!left_edge)
           break;
-        const Polygon2D::Vertex* left_edge_y_min_vertex =
-            y_min_vertices[left_edge.value()];
-        dcel_polygon.InsertEdge({vertex->point, left_edge_y_min_vertex->point});
-        y_min_vertices[left_edge.value()] = vertex;
+        if (helpers[*left_edge] != kNoHelper)
+          dcel_polygon->InsertEdge({point, Point(helpers[*left_edge])});
+        helpers[*left_edge] = vertex;
         break;
       }
       case Polygon2D::MERGE: {
-        const Segment2D next_edge = {vertex->next->point, vertex->point};
-        const Polygon2D::Vertex* next_y_min_vertex = y_min_vertices[next_edge];
-        if (next_y_min_vertex->type == Polygon2D::MERGE)
-          dcel_polygon.InsertEdge({vertex->point, next_y_min_vertex->point});
-        left_edges.Remove(next_edge);
-        const std::optional<Segment2D> left_edge =
-          left_edges.FirstLeft(vertex->point);
+        RemoveLeftEdge(vertex);
+        const std::optional<uint32_t> left_edge =
+            left_edges.FirstLeftTag(point);
         if (!left_edge)
           break;
-        const Polygon2D::Vertex* left_edge_y_min_vertex =
-            y_min_vertices[left_edge.value()];
-        if (left_edge_y_min_vertex->type == Polygon2D::MERGE)
-          dcel_polygon.InsertEdge(
-              {vertex->point, left_edge_y_min_vertex->point});
-        y_min_vertices[left_edge.value()] = vertex;
+        ConnectToMergeHelper(vertex, *left_edge);
+        helpers[*left_edge] = vertex;
         break;
       }
-      case Polygon2D::LEFT_REGULAR: {
-        const Segment2D next_edge = {vertex->next->point, vertex->point};
-        const Segment2D prev_edge = {vertex->point, vertex->prev->point};
-        if (y_min_vertices[next_edge]->type == Polygon2D::MERGE)
-          dcel_polygon.InsertEdge(
-              {vertex->point, y_min_vertices[next_edge]->point});
-        left_edges.Remove(next_edge);
-        left_edges.Add(prev_edge);
-        y_min_vertices[prev_edge] = vertex;
+      case Polygon2D::LEFT_REGULAR:
+        RemoveLeftEdge(vertex);
+        AddLeftEdge(vertex);
         break;
-      }
       case Polygon2D::RIGHT_REGULAR: {
-        const std::optional<Segment2D> left_edge =
-          left_edges.FirstLeft(vertex->point);
+        const std::optional<uint32_t> left_edge =
+            left_edges.FirstLeftTag(point);
         if (!left_edge)
           break;
-        const Polygon2D::Vertex* y_min_vertex =
-            y_min_vertices[left_edge.value()];
-        if (y_min_vertex->type == Polygon2D::MERGE)
-          dcel_polygon.InsertEdge({vertex->point, y_min_vertex->point});
-        y_min_vertices[left_edge.value()] = vertex;
+        ConnectToMergeHelper(vertex, *left_edge);
+        helpers[*left_edge] = vertex;
         break;
       }
     }
   }
-  return dcel_polygon.GetPolygons();
+}
+
+}  // namespace
+
+std::pmr::list<Polygon2D> DecomposeToYMonotones(
+    const Polygon2D& polygon,
+    std::pmr::memory_resource* memory,
+    TriangulationStats* stats) {
+  return DecomposeToYMonotones(polygon, std::pmr::vector<Polygon2D>(memory),
+                               memory, stats);
+}
+
+std::pmr::list<Polygon2D> DecomposeToYMonotones(
+    const Polygon2D& polygon,
+    const std::pmr::vector<Polygon2D>& holes,
+    std::pmr::memory_resource* memory,
+    TriangulationStats* stats) {
+  std::pmr::list<Polygon2D> res(memory);
+  DecomposeToYMonotones(polygon, holes, [&](Polygon2D&& y_monotone) {
+    res.push_back(std::move(y_monotone));
+  }, memory, stats);
+  return res;
+}
+
+void DecomposeToYMonotones(
+    const Polygon2D& polygon,
+    const std::function<void(Polygon2D&&)>& consume,
+    std::pmr::memory_resource* memory,
+    TriangulationStats* stats) {
+  DecomposeToYMonotones(polygon, std::pmr::vector<Polygon2D>(memory),
+                        consume, memory, stats);
+}
+
+void DecomposeToYMonotones(
+    const Polygon2D& polygon,
+    const std::pmr::vector<Polygon2D>& holes,
+    const std::function<void(Polygon2D&&)>& consume,
+    std::pmr::memory_resource* memory,
+    TriangulationStats* stats) {
+  // There are at most as many diagonals as split and merge vertices
+  auto SplitsAndMerges = [](const Polygon2D& ring) {
+    return static_cast<size_t>(std::count_if(
+        ring.Types(), ring.Types() + ring.Size(),
+        [](Polygon2D::VertexType type) {
+          return type == Polygon2D::SPLIT || type == Polygon2D::MERGE;
+        }));
+  };
+  size_t diagonals = SplitsAndMerges(polygon);
+  for (const Polygon2D& hole : holes)
+    diagonals += SplitsAndMerges(hole);
+  DcelPolygon2D dcel_polygon(polygon, holes, memory, stats, diagonals);
+  InsertDiagonals(polygon, holes, memory, &dcel_polygon);
+  dcel_polygon.ConsumePolygons(consume);
 }
 
 }  // geom
@@ -3,18 +3,51 @@
 
 #include <geom_utils.h>
 #include <polygon2d.h>
+#include <triangulation_stats.h>
 
+#include <functional>
 #include <list>
+#include <memory_resource>
 #include <vector>
 
 namespace geom {
 
 // returns std::list to avoid redundant Polygon2D copying
 // since Polygon2D construction is extremely costly
-// and it's hard to precalculate number of result y-monotones
-// since DcelPolygon2D stores redundant faces
-std::list<Polygon2D> DecomposeToYMonotones(
-    const std::vector<Point2D>& polygon_v);
+// and number of result y-monotones (one more than number
+// of inserted diagonals) is known only after the sweep
+// Takes ready simple polygon (e.g. piece returned by ResolveIntersections)
+// so vertices aren't rebuilt between the stages
+std::pmr::list<Polygon2D> DecomposeToYMonotones(
+    const Polygon2D& polygon,
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+    TriangulationStats* stats = nullptr);
+
+// Holes (see Polygon2D::HoleFromRing) go through the same sweep,
+// their top and bottom vertices are SPLIT and MERGE ones
+// and get connected to the rest of the polygon by the diagonals
+// Rings must be simple and must not touch each other
+std::pmr::list<Polygon2D> DecomposeToYMonotones(
+    const Polygon2D& polygon,
+    const std::pmr::vector<Polygon2D>& holes,
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+    TriangulationStats* stats = nullptr);
+
+// Streaming versions of the above, every y-monotone is handed
+// to consume as soon as it's built and the sweep state is freed
+// before the first one, so peak memory doesn't grow with the number
+// of y-monotones
+void DecomposeToYMonotones(
+    const Polygon2D& polygon,
+    const std::function<void(Polygon2D&&)>& consume,
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+    TriangulationStats* stats = nullptr);
+void DecomposeToYMonotones(
+    const Polygon2D& polygon,
+    const std::pmr::vector<Polygon2D>& holes,
+    const std::function<void(Polygon2D&&)>& consume,
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+    TriangulationStats* stats = nullptr);
 
 }  // geom
 
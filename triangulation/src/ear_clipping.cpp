@@ -0,0 +1,157 @@
+#include <ear_clipping.h>
+
+#include <geom_utils.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace geom {
+
+namespace {
+
+// Boundary of clockwise triangle abc is counted as inside
+bool InTriangle(const Point2D& a, const Point2D& b, const Point2D& c,
+                const Point2D& point) {
+  return Orient2D(a, b, point) <= 0 && Orient2D(b, c, point) <= 0 &&
+         Orient2D(c, a, point) <= 0;
+}
+
+// Remaining vertices of the polygon linked into a ring by indices
+class EarRing {
+ public:
+  EarRing(const Polygon2D& polygon, std::pmr::memory_resource* memory) :
+      points_(memory), prev_(memory), next_(memory),
+      ear_(polygon.Size(), UNKNOWN, memory), size_(polygon.Size()) {
+    points_.reserve(size_);
+    prev_.reserve(size_);
+    next_.reserve(size_);
+    for (uint32_t i = 0; i < size_; i++) {
+      points_.push_back(polygon.Point(i));
+      prev_.push_back(i == 0 ? size_ - 1 : i - 1);
+      next_.push_back(i + 1 == size_ ? 0 : i + 1);
+    }
+  }
+
+  uint32_t Size() const { return size_; }
+  uint32_t Next(uint32_t vertex) const { return next_[vertex]; }
+
+  int TurnAt(uint32_t vertex) const {
+    return Orient2D(points_[prev_[vertex]], points_[vertex],
+                    points_[next_[vertex]]);
+  }
+
+  // Ear is a strictly convex vertex with no other vertex
+  // inside or on its triangle
+  // Vertices equal to corners of the ear are skipped
+  // so polygons pinched at a vertex can still be clipped
+  // Status is cached: in a simple polygon clipping an ear changes
+  // the status of its two neighbours only, so every vertex is checked
+  // O(1) times and the whole clipping is O(N^2)
+  bool IsEar(uint32_t vertex) {
+    if (ear_[vertex] == UNKNOWN)
+      ear_[vertex] = CheckEar(vertex) ? EAR : NOT_EAR;
+    return ear_[vertex] == EAR;
+  }
+
+  // Degenerate pieces may hide an ear behind a clipped one,
+  // statuses are rechecked from scratch then
+  void ForgetEars() {
+    std::fill(ear_.begin(), ear_.end(), UNKNOWN);
+  }
+
+  VertexTriangle EarTriangle(uint32_t vertex) const {
+    return {prev_[vertex], vertex, next_[vertex]};
+  }
+
+  void Remove(uint32_t vertex) {
+    next_[prev_[vertex]] = next_[vertex];
+    prev_[next_[vertex]] = prev_[vertex];
+    ear_[prev_[vertex]] = UNKNOWN;
+    ear_[next_[vertex]] = UNKNOWN;
+    size_--;
+  }
+
+  bool IsFlat(uint32_t any_vertex) const {
+    uint32_t vertex = any_vertex;
+    do {
+      if (TurnAt(vertex) != 0)
+        return false;
+      vertex = next_[vertex];
+    } while (vertex != any_vertex);
+    return true;
+  }
+
+ private:
+  enum EarStatus : uint8_t {
+    UNKNOWN,
+    EAR,
+    NOT_EAR
+  };
+
+  bool CheckEar(uint32_t vertex) const {
+    if (TurnAt(vertex) >= 0)
+      return false;
+    const Point2D& a = points_[prev_[vertex]];
+    const Point2D& b = points_[vertex];
+    const Point2D& c = points_[next_[vertex]];
+    for (uint32_t other = next_[next_[vertex]]; other != prev_[vertex];
+         other = next_[other]) {
+      const Point2D& point = points_[other];
+      if (point == a || point == b || point == c)
+        continue;
+      if (InTriangle(a, b, c, point))
+        return false;
+    }
+    return true;
+  }
+
+  std::pmr::vector<Point2D> points_;
+  std::pmr::vector<uint32_t> prev_;
+  std::pmr::vector<uint32_t> next_;
+  std::pmr::vector<EarStatus> ear_;
+  uint32_t size_;
+};
+
+}  // namespace
+
+std::optional<std::pmr::vector<VertexTriangle> > TriangulateByEarClipping(
+    const Polygon2D& polygon,
+    std::pmr::memory_resource* memory) {
+  std::pmr::vector<VertexTriangle> triangles(memory);
+  if (polygon.Size() < 3)
+    return triangles;
+  triangles.reserve(polygon.Size() - 2);
+
+  EarRing ring(polygon, memory);
+  uint32_t current = 0;
+  // Vertices checked since the last clipped ear
+  uint32_t checked = 0;
+  bool forgot_ears = false;
+  while (ring.Size() > 3) {
+    if (ring.IsEar(current)) {
+      triangles.push_back(ring.EarTriangle(current));
+      const uint32_t next = ring.Next(current);
+      ring.Remove(current);
+      current = next;
+      checked = 0;
+      continue;
+    }
+    current = ring.Next(current);
+    if (++checked == ring.Size()) {
+      // Only once, so degenerate pieces stay O(N^2) too
+      if (forgot_ears)
+        break;
+      ring.ForgetEars();
+      forgot_ears = true;
+      checked = 0;
+    }
+  }
+
+  if (ring.Size() == 3 && ring.TurnAt(current) < 0)
+    triangles.push_back(ring.EarTriangle(current));
+  else if (!ring.IsFlat(current))
+    return {};
+  return triangles;
+}
+
+}  // geom
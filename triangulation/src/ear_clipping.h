@@ -0,0 +1,27 @@
+#ifndef EAR_CLIPPING_H
+#define EAR_CLIPPING_H
+
+#include <polygon2d.h>
+#include <triangulation_base_geometry.h>
+
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace geom {
+
+// O(N^2) ear clipping of a simple polygon over flat arrays
+// It has much smaller constant than the monotone pipeline
+// and wins on small polygons
+// Triangles are clockwise as the ones made by the pipeline
+// and are given by vertices of the polygon
+// Zero-area rest of the polygon (all vertices on one line) is dropped
+// Returns nothing if no ear is found while polygon isn't done,
+// may happen on degenerate pieces (touching or overlapping edges)
+std::optional<std::pmr::vector<VertexTriangle> > TriangulateByEarClipping(
+    const Polygon2D& polygon,
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+}  // geom
+
+#endif  // EAR_CLIPPING_H
@@ -1,5 +1,6 @@
 #include <geom_utils.h>
 
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cmath>
@@ -19,11 +20,266 @@ bool operator==(const Point2D& lhp, const Point2D& rhp) {
   return !(rhp != lhp);
 }
 
-bool MoreThenPiAngle2D(const Vector2D& v, const Vector2D& u) {
-  const double z = v.x*u.y - v.y*u.x;
-  if (DoubleEqual(z, 0))
-    return false;
-  return z < 0;
+namespace {
+
+// Exact sign of a*b - c*d
+// Rounding is monotonic so rounded products are ordered
+// as the exact ones unless they are equal,
+// in that case it's decided by the exact rounding errors
+int ProductDifferenceSign(double a, double b, double c, double d) {
+  const double ab = a*b;
+  const double cd = c*d;
+  if (ab != cd)
+    return ab < cd ? -1 : 1;
+  const double ab_err = std::fma(a, b, -ab);
+  const double cd_err = std::fma(c, d, -cd);
+  if (ab_err != cd_err)
+    return ab_err < cd_err ? -1 : 1;
+  return 0;
+}
+
+bool IsLowerHalfPlane(const Vector2D& v) {
+  return v.y < 0 || (v.y == 0 && v.x < 0);
+}
+
+// Error of x of a segment at y relative to |a.x| + |(x - a.x)|,
+// it takes two differences, a quotient, a product and a sum
+constexpr double kXAtYError = 8 * kRoundingError;
+
+// Exact value as the sum of nonoverlapping terms of increasing magnitude
+// (expansion from the same paper), zero terms are dropped,
+// so the sign is the sign of the last term
+// Terms are kept on the stack, the predicates need at most 96 of them
+class Expansion {
+ public:
+  Expansion() : size_(0) {}
+  explicit Expansion(double value) : size_(0) { Add(value); }
+
+  // Exact a - b
+  static Expansion Difference(double a, double b) {
+    Expansion res(a);
+    res.Add(-b);
+    return res;
+  }
+
+  void Add(double value) {
+    size_t size = 0;
+    for (size_t i = 0; i < size_; i++) {
+      double error;
+      value = TwoSum(value, terms_[i], &error);
+      if (error != 0)
+        terms_[size++] = error;
+    }
+    if (value != 0) {
+      assert(size < kCapacity);
+      terms_[size++] = value;
+    }
+    size_ = size;
+  }
+
+  void Add(const Expansion& other) {
+    for (size_t i = 0; i < other.size_; i++)
+      Add(other.terms_[i]);
+  }
+
+  Expansion Times(double value) const {
+    Expansion res;
+    for (size_t i = 0; i < size_; i++) {
+      const double product = terms_[i] * value;
+      res.Add(std::fma(terms_[i], value, -product));
+      res.Add(product);
+    }
+    return res;
+  }
+
+  Expansion Times(const Expansion& other) const {
+    Expansion res;
+    for (size_t i = 0; i < other.size_; i++)
+      res.Add(Times(other.terms_[i]));
+    return res;
+  }
+
+  void Negate() {
+    for (size_t i = 0; i < size_; i++)
+      terms_[i] = -terms_[i];
+  }
+
+  int Sign() const {
+    if (size_ == 0)
+      return 0;
+    return terms_[size_ - 1] > 0 ? 1 : -1;
+  }
+
+ private:
+  static constexpr size_t kCapacity = 128;
+
+  // a + b rounded, the rounding error is stored to error
+  static double TwoSum(double a, double b, double* error) {
+    const double sum = a + b;
+    const double b_virtual = sum - a;
+    const double a_virtual = sum - b_virtual;
+    *error = (a - a_virtual) + (b - b_virtual);
+    return sum;
+  }
+
+  size_t size_;
+  double terms_[kCapacity];
+};
+
+int SignWithin(double value, double error) {
+  if (value > error)
+    return 1;
+  if (-value > error)
+    return -1;
+  return 0;
+}
+
+// Rounded x of the segment at y and the bound of its error,
+// x at y of an end is exact
+double XAtY(const Segment2D& segment, double y, double* error) {
+  *error = 0;
+  if (y == segment.a.y || segment.a.y == segment.b.y)
+    return segment.a.x;
+  if (y == segment.b.y)
+    return segment.b.x;
+  const double dx = (segment.b.x - segment.a.x) *
+                    ((y - segment.a.y) / (segment.b.y - segment.a.y));
+  *error = kXAtYError * (std::abs(segment.a.x) + std::abs(dx));
+  return segment.a.x + dx;
+}
+
+// Same as above with the quotient taken first,
+// it has as many roundings, so the same error bound
+double XAtY(const SlopedSegment2D& sloped, double y, double* error) {
+  const Segment2D& segment = sloped.segment;
+  *error = 0;
+  if (y == segment.a.y || segment.a.y == segment.b.y)
+    return segment.a.x;
+  if (y == segment.b.y)
+    return segment.b.x;
+  const double dx = (y - segment.a.y) * sloped.inverse_slope;
+  *error = kXAtYError * (std::abs(segment.a.x) + std::abs(dx));
+  return segment.a.x + dx;
+}
+
+// x of the segment at y is numerator / denominator,
+// the denominator is positive
+void ExactXAtY(const Segment2D& segment, double y,
+               Expansion* numerator, Expansion* denominator) {
+  if (segment.a.y == segment.b.y) {
+    *numerator = Expansion(segment.a.x);
+    *denominator = Expansion(1);
+    return;
+  }
+  *denominator = Expansion::Difference(segment.b.y, segment.a.y);
+  *numerator = denominator->Times(segment.a.x);
+  numerator->Add(Expansion::Difference(segment.b.x, segment.a.x).Times(
+      Expansion::Difference(y, segment.a.y)));
+  if (segment.b.y < segment.a.y) {
+    numerator->Negate();
+    denominator->Negate();
+  }
+}
+
+// Exact fallbacks are kept out of line,
+// so the filtered paths stay small
+
+[[gnu::noinline]] int ExactCrossProductSign(const Point2D& a,
+                                            const Point2D& b,
+                                            const Point2D& c,
+                                            const Point2D& d) {
+  Expansion det = Expansion::Difference(b.x, a.x).Times(
+      Expansion::Difference(d.y, c.y));
+  Expansion det_right = Expansion::Difference(b.y, a.y).Times(
+      Expansion::Difference(d.x, c.x));
+  det_right.Negate();
+  det.Add(det_right);
+  return det.Sign();
+}
+
+[[gnu::noinline]] int ExactCompareXAtY(const Segment2D& lhs,
+                                       const Segment2D& rhs, double y) {
+  Expansion lhs_numerator, lhs_denominator, rhs_numerator, rhs_denominator;
+  ExactXAtY(lhs, y, &lhs_numerator, &lhs_denominator);
+  ExactXAtY(rhs, y, &rhs_numerator, &rhs_denominator);
+  Expansion diff = lhs_numerator.Times(rhs_denominator);
+  Expansion diff_right = rhs_numerator.Times(lhs_denominator);
+  diff_right.Negate();
+  diff.Add(diff_right);
+  return diff.Sign();
+}
+
+// Into the common part of ranges between a1, a2 and between b1, b2
+double Clamp(double value, double a1, double a2, double b1, double b2) {
+  return std::clamp(value, std::max(std::min(a1, a2), std::min(b1, b2)),
+                    std::min(std::max(a1, a2), std::max(b1, b2)));
+}
+
+}  // namespace
+
+bool PolarAngleLess(const Vector2D& v, const Vector2D& u) {
+  const bool v_lower = IsLowerHalfPlane(v);
+  const bool u_lower = IsLowerHalfPlane(u);
+  if (v_lower != u_lower)
+    return v_lower;
+  return CrossProductSign(v, u) > 0;
+}
+
+int CrossProductSign(const Vector2D& v, const Vector2D& u) {
+  return ProductDifferenceSign(v.x, u.y, v.y, u.x);
+}
+
+int CrossProductSign(const Point2D& a, const Point2D& b,
+                     const Point2D& c, const Point2D& d) {
+  const double left = (b.x - a.x) * (d.y - c.y);
+  const double right = (b.y - a.y) * (d.x - c.x);
+  const double bound = kCrossProductErrorBound *
+                       (std::abs(left) + std::abs(right));
+  const int sign = SignWithin(left - right, bound);
+  // Zero bound means both products are exact zeros
+  if (sign != 0 || bound == 0)
+    return sign;
+  return ExactCrossProductSign(a, b, c, d);
+}
+
+int Orient2D(const Point2D& a, const Point2D& b, const Point2D& c) {
+  return CrossProductSign(a, b, a, c);
+}
+
+bool InBoundingBox(const Segment2D& segment, const Point2D& point) {
+  return std::min(segment.a.x, segment.b.x) <= point.x &&
+         point.x <= std::max(segment.a.x, segment.b.x) &&
+         std::min(segment.a.y, segment.b.y) <= point.y &&
+         point.y <= std::max(segment.a.y, segment.b.y);
+}
+
+int CompareXAtY(const Segment2D& lhs, const Segment2D& rhs, double y) {
+  double lhs_error, rhs_error;
+  const double lhx = XAtY(lhs, y, &lhs_error);
+  const double rhx = XAtY(rhs, y, &rhs_error);
+  const double bound = lhs_error + rhs_error;
+  const int sign = SignWithin(lhx - rhx, bound);
+  if (sign != 0 || bound == 0)
+    return sign;
+  return ExactCompareXAtY(lhs, rhs, y);
+}
+
+SlopedSegment2D::SlopedSegment2D(const Segment2D& segment) :
+    segment(segment),
+    inverse_slope(segment.a.y == segment.b.y ?
+                  0 : (segment.b.x - segment.a.x) /
+                      (segment.b.y - segment.a.y)) {}
+
+int CompareXAtY(const SlopedSegment2D& lhs, const SlopedSegment2D& rhs,
+                double y) {
+  double lhs_error, rhs_error;
+  const double lhx = XAtY(lhs, y, &lhs_error);
+  const double rhx = XAtY(rhs, y, &rhs_error);
+  const double bound = lhs_error + rhs_error;
+  const int sign = SignWithin(lhx - rhx, bound);
+  if (sign != 0 || bound == 0)
+    return sign;
+  return ExactCompareXAtY(lhs.segment, rhs.segment, y);
 }
 
 bool operator<(const Segment2D& lhs, const Segment2D& rhs) {
@@ -36,21 +292,15 @@ bool operator==(const Segment2D& lhs, const Segment2D& rhs) {
 
 bool YFirstPoint2DComparator::operator()(const Point2D& lhp,
                                          const Point2D& rhp) const {
-  if (DoubleEqual(lhp, rhp))
-    return false;
-  if (DoubleEqual(lhp.y, rhp.y))
-    return lhp.x > rhp.x;
-  return lhp.y < rhp.y;
+  if (lhp.y != rhp.y)
+    return lhp.y < rhp.y;
+  return lhp.x > rhp.x;
 }
 
 bool DoubleEqual(double lhd, double rhd) {
   return std::abs(lhd - rhd) < 1e-10;
 }
 
-bool DoubleLessOrEqual(double lhd, double rhd) {
-  return DoubleEqual(lhd, rhd) || lhd < rhd;
-}
-
 bool DoubleEqual(const geom::Point2D& lhp, const geom::Point2D& rhp) {
   return geom::DoubleEqual(lhp.x, rhp.x) && geom::DoubleEqual(lhp.y, rhp.y);
 }
@@ -59,52 +309,42 @@ bool DoubleEqual(const geom::Segment2D& lhs, const geom::Segment2D& rhs) {
   return geom::DoubleEqual(lhs.a, rhs.a) && geom::DoubleEqual(lhs.b, rhs.b);
 }
 
-// assuming that vectors are collinear
-double MagnitudeRatio(const Vector2D& v, const Vector2D& u) {
-  const double v_sqr = v.x*v.x + v.y*v.y;
-  const double v_u = v.x*u.x + v.y*u.y;
-  return v_sqr / v_u;
-}
-
-// assuming that the segment and the point are on the same line
-bool IsPointInsideSegment(const Segment2D& segment, const Point2D& point) {
-  if (DoubleEqual(segment.a, point) || DoubleEqual(segment.a, segment.b))
-    return DoubleEqual(segment.a, point);
-  const double k = MagnitudeRatio({segment.a, point}, {segment.a, segment.b});
-  return DoubleLessOrEqual(0, k) && DoubleLessOrEqual(k, 1);
-}
-
 std::optional<Point2D> IntersectionPoint(const Segment2D& a,
                                          const Segment2D& b) {
+  const int b_a = Orient2D(a.a, a.b, b.a);
+  const int b_b = Orient2D(a.a, a.b, b.b);
+  if (b_a == 0 && b_b == 0) {
+    // On the same line
+    if (InBoundingBox(a, b.a))
+      return b.a;
+    if (InBoundingBox(a, b.b))
+      return b.b;
+    return {};
+  }
+  const int a_a = Orient2D(b.a, b.b, a.a);
+  const int a_b = Orient2D(b.a, b.b, a.b);
+  if (b_a * b_b > 0 || a_a * a_b > 0)
+    return {};
+  if (b_a == 0)
+    return b.a;
+  if (b_b == 0)
+    return b.b;
+  if (a_a == 0)
+    return a.a;
+  if (a_b == 0)
+    return a.b;
+
+  // Proper crossing, the rounded point is kept inside both segments
   const Vector2D v1 = {a.a, a.b};
   const Vector2D v2 = {b.a, b.b};
-  const double s1 = v1.x*v2.y - v1.y*v2.x;
   const Vector2D v3 = {a.a, b.a};
-  const double s2 = v1.x*v3.y - v1.y*v3.x;
-  if (DoubleEqual(s1, 0)) {
-    if (DoubleEqual(s2, 0)) {
-      // On the same line
-      if (IsPointInsideSegment(a, b.a))
-        return b.a;
-      if (IsPointInsideSegment(a, b.b))
-        return b.b;
-      return {};
-    }
-    // Parallel
-    return {};
-  }
-  const double s3 = v3.x*v2.y - v3.y*v2.x;
-  const double k = s3/s1;
-  const Point2D line_intersection_point = {a.a.x + v1.x * k, a.a.y + v1.y * k};
-  if (IsPointInsideSegment(a, line_intersection_point) &&
-      IsPointInsideSegment(b, line_intersection_point))
-    return line_intersection_point;
-  return {};
+  const double k = (v3.x*v2.y - v3.y*v2.x) / (v1.x*v2.y - v1.y*v2.x);
+  return Point2D(Clamp(a.a.x + v1.x * k, a.a.x, a.b.x, b.a.x, b.b.x),
+                 Clamp(a.a.y + v1.y * k, a.a.y, a.b.y, b.a.y, b.b.y));
 }
 
 bool IsIntersectionOnVertex(const Segment2D& a, const Segment2D& b) {
-  return DoubleEqual(a.a, b.a) || DoubleEqual(a.a, b.b) ||
-         DoubleEqual(a.b, b.a) || DoubleEqual(a.b, b.b);
+  return a.a == b.a || a.a == b.b || a.b == b.a || a.b == b.b;
 }
 
 std::size_t CombineHash(std::size_t left, std::size_t right) {
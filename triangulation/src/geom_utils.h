@@ -3,8 +3,11 @@
 
 #include <triangulation_base_geometry.h>
 
+#include <cmath>
 #include <functional>
+#include <limits>
 #include <optional>
+#include <type_traits>
 
 namespace geom {
 
@@ -29,16 +32,64 @@ bool operator<(const Point2D& lhp, const Point2D& rhp);
 bool operator!=(const Point2D& lhp, const Point2D& rhp);
 bool operator==(const Point2D& lhp, const Point2D& rhp);
 
-bool MoreThenPiAngle2D(const Vector2D& v, const Vector2D& u);
+// Exact polar angle order in [-pi, pi) without atan2
+// First by half-plane, then by sign of cross product
+// Vectors with the same direction are equivalent
+bool PolarAngleLess(const Vector2D& v, const Vector2D& u);
+
+// Exact sign of cross product v x u
+// (positive when u is counterclockwise from v)
+int CrossProductSign(const Vector2D& v, const Vector2D& u);
+
+// Predicates on points below are exact for any input:
+// the floating-point result is taken when it's above its error bound,
+// otherwise the value is recomputed with exact expansion arithmetic
+
+// Half of the machine epsilon, bound of relative rounding error
+constexpr double kRoundingError = std::numeric_limits<double>::epsilon() / 2;
+// Error of a difference of two products of differences
+// relative to the sum of magnitudes of the products (J. R. Shewchuk,
+// Adaptive Precision Floating-Point Arithmetic and Fast Robust
+// Geometric Predicates)
+constexpr double kCrossProductErrorBound = (3 + 16 * kRoundingError) *
+                                           kRoundingError;
+
+// Sign of (b - a) x (d - c)
+int CrossProductSign(const Point2D& a, const Point2D& b,
+                     const Point2D& c, const Point2D& d);
+// Positive for counterclockwise a -> b -> c, zero for collinear points
+int Orient2D(const Point2D& a, const Point2D& b, const Point2D& c);
+// Closed bounding box test, enough for a point on the line of the segment
+bool InBoundingBox(const Segment2D& segment, const Point2D& point);
+// Sign of x(lhs) - x(rhs) on the horizontal line at y,
+// x of a horizontal segment is x of its a end
+int CompareXAtY(const Segment2D& lhs, const Segment2D& rhs, double y);
+
+// Segment with the inverse slope of its line computed once,
+// so x at y takes a product instead of a quotient
+struct SlopedSegment2D {
+  Segment2D segment;
+  // dx / dy, zero for a horizontal segment
+  double inverse_slope;
+  explicit SlopedSegment2D(const Segment2D& segment);
+};
+
+// Same as CompareXAtY of the segments
+int CompareXAtY(const SlopedSegment2D& lhs, const SlopedSegment2D& rhs,
+                double y);
 
 bool operator<(const Segment2D& lhs, const Segment2D& rhs);
 bool operator==(const Segment2D& lhs, const Segment2D& rhs);
 
+// Used to merge repeated vertices only, not by the predicates
 bool DoubleEqual(double lhd, double rhd);
-bool DoubleLessOrEqual(double lhd, double rhd);
 bool DoubleEqual(const geom::Point2D& lhp, const geom::Point2D& rhp);
 bool DoubleEqual(const geom::Segment2D& lhs, const geom::Segment2D& rhs);
 
+// Whether the segments intersect is decided exactly,
+// touching at an end gives the end itself,
+// only the point of a proper crossing is rounded
+// Collinear segments give an end of b lying on a if any
 std::optional<Point2D> IntersectionPoint(const Segment2D& a,
                                          const Segment2D& b);
 
@@ -46,6 +97,29 @@ bool IsIntersectionOnVertex(const Segment2D& a, const Segment2D& b);
 
 std::size_t CombineHash(std::size_t left, std::size_t right);
 
+// Exact for every coordinate type of BasicPoint2D
+template<class T>
+Point2D ToPoint2D(const BasicPoint2D<T>& point) {
+  return Point2D(point.x, point.y);
+}
+
+// Integer coordinates are rounded to the nearest
+template<class T>
+BasicPoint2D<T> FromPoint2D(const Point2D& point) {
+  if constexpr (std::is_integral_v<T>)
+    return BasicPoint2D<T>(static_cast<T>(std::lround(point.x)),
+                           static_cast<T>(std::lround(point.y)));
+  else
+    return BasicPoint2D<T>(static_cast<T>(point.x), static_cast<T>(point.y));
+}
+
+template<class T>
+BasicTriangle2D<T> FromTriangle2D(const Triangle2D& triangle) {
+  return BasicTriangle2D<T>(FromPoint2D<T>(triangle.a),
+                            FromPoint2D<T>(triangle.b),
+                            FromPoint2D<T>(triangle.c));
+}
+
 }  // geom
 
 namespace std {
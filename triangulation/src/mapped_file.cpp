@@ -0,0 +1,86 @@
+#include <triangulation_mapped_file.h>
+
+#include <cstdio>
+
+#if __has_include(<sys/mman.h>)
+#define MAPPED_FILE_USE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace geom {
+
+#ifdef MAPPED_FILE_USE_MMAP
+
+MappedFile::MappedFile(const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == 0) {
+    size_ = static_cast<size_t>(file_stat.st_size);
+    if (size_ == 0) {
+      open_ = true;
+    } else {
+      data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        size_ = 0;
+      } else {
+        open_ = true;
+        // Polygon is read once from start to end
+        madvise(data_, size_, MADV_SEQUENTIAL);
+      }
+    }
+  }
+  // Mapping stays valid without the descriptor
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_)
+    munmap(data_, size_);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path) {
+  std::FILE* file = std::fopen(path.c_str(), "rb");
+  if (!file)
+    return;
+  if (std::fseek(file, 0, SEEK_END) == 0) {
+    const long size = std::ftell(file);
+    if (size >= 0 && std::fseek(file, 0, SEEK_SET) == 0) {
+      contents_.resize(static_cast<size_t>(size));
+      if (std::fread(contents_.data(), 1, contents_.size(), file) ==
+          contents_.size()) {
+        open_ = true;
+        size_ = contents_.size();
+        data_ = size_ ? contents_.data() : nullptr;
+      } else {
+        contents_.clear();
+      }
+    }
+  }
+  std::fclose(file);
+}
+
+MappedFile::~MappedFile() = default;
+
+#endif  // MAPPED_FILE_USE_MMAP
+
+bool MappedFile::IsOpen() const {
+  return open_;
+}
+
+const void* MappedFile::Data() const {
+  return data_;
+}
+
+size_t MappedFile::Size() const {
+  return size_;
+}
+
+}  // geom
@@ -0,0 +1,236 @@
+#include <parallel_for.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace geom {
+
+namespace {
+
+struct alignas(64) WorkRange {
+  std::mutex mutex;
+  size_t begin = 0;
+  size_t end = 0;
+
+  bool PopFront(size_t* index) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (begin == end)
+      return false;
+    *index = begin++;
+    return true;
+  }
+
+  size_t Size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return end - begin;
+  }
+
+  bool StealBack(size_t* stolen_begin, size_t* stolen_end) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (begin == end)
+      return false;
+    *stolen_end = end;
+    end -= (end - begin + 1) / 2;
+    *stolen_begin = end;
+    return true;
+  }
+
+  void Reset(size_t new_begin, size_t new_end) {
+    std::lock_guard<std::mutex> lock(mutex);
+    begin = new_begin;
+    end = new_end;
+  }
+};
+
+// Work may be "in flight" between two ranges during a steal,
+// so a thief may exit a bit early, but no index is ever lost
+bool Steal(std::vector<WorkRange>& ranges, size_t thief) {
+  while (true) {
+    size_t victim = thief;
+    size_t victim_size = 0;
+    for (size_t i = 0; i < ranges.size(); i++) {
+      if (i == thief)
+        continue;
+      const size_t size = ranges[i].Size();
+      if (size > victim_size) {
+        victim = i;
+        victim_size = size;
+      }
+    }
+    if (victim_size == 0)
+      return false;
+
+    size_t stolen_begin, stolen_end;
+    if (ranges[victim].StealBack(&stolen_begin, &stolen_end)) {
+      ranges[thief].Reset(stolen_begin, stolen_end);
+      return true;
+    }
+  }
+}
+
+// One call of ParallelFor, shared with the pool workers helping it
+// Workers that come after the caller has finished only see it closed
+struct Job {
+  Job(size_t n, size_t num_threads,
+      const std::function<void(size_t, size_t)>& body) :
+      ranges(num_threads), body(body) {
+    for (size_t t = 0; t < num_threads; t++)
+      ranges[t].Reset(n * t / num_threads, n * (t + 1) / num_threads);
+  }
+
+  // Range t is owned by the t-th participant, the caller owns range 0
+  void Run(size_t t) {
+    try {
+      size_t i;
+      while (true) {
+        if (ranges[t].PopFront(&i))
+          body(i, t);
+        else if (!Steal(ranges, t))
+          break;
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!exception)
+        exception = std::current_exception();
+      for (WorkRange& range : ranges)
+        range.Reset(0, 0);
+    }
+  }
+
+  // Called by a pool worker, ranges of the participants which never came
+  // are stolen by the others
+  void Help() {
+    size_t t;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (closed || next_range == ranges.size())
+        return;
+      t = next_range++;
+      active_helpers++;
+    }
+    Run(t);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--active_helpers == 0)
+      helpers_done.notify_one();
+  }
+
+  // Called by the caller after its own Run, every index is taken by then
+  // but helpers may still be running the last ones
+  void Close() {
+    std::unique_lock<std::mutex> lock(mutex);
+    closed = true;
+    helpers_done.wait(lock, [this]() { return active_helpers == 0; });
+  }
+
+  std::vector<WorkRange> ranges;
+  const std::function<void(size_t, size_t)>& body;
+
+  std::mutex mutex;
+  std::condition_variable helpers_done;
+  size_t next_range = 1;
+  size_t active_helpers = 0;
+  bool closed = false;
+  std::exception_ptr exception;
+};
+
+// Process-wide threads, started on demand and kept until exit,
+// so repeated calls don't pay for thread start-up
+// Callers never wait for a worker to become free, a job nobody helps
+// is done by its caller alone, so nested calls can't deadlock
+class WorkerPool {
+ public:
+  static WorkerPool& Instance() {
+    static WorkerPool pool;
+    return pool;
+  }
+
+  ~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopping_ = true;
+    }
+    has_jobs_.notify_all();
+    for (std::thread& thread : threads_)
+      thread.join();
+  }
+
+  // Asks helpers of the pool threads to join the job
+  void Submit(const std::shared_ptr<Job>& job, size_t helpers) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      while (threads_.size() < helpers)
+        threads_.emplace_back([this]() { WorkLoop(); });
+      for (size_t i = 0; i < helpers; i++)
+        jobs_.push_back(job);
+    }
+    if (helpers == 1)
+      has_jobs_.notify_one();
+    else
+      has_jobs_.notify_all();
+  }
+
+ private:
+  WorkerPool() = default;
+
+  void WorkLoop() {
+    while (true) {
+      std::shared_ptr<Job> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        has_jobs_.wait(lock, [this]() {
+          return stopping_ || !jobs_.empty();
+        });
+        if (jobs_.empty())
+          return;
+        job = std::move(jobs_.front());
+        jobs_.pop_front();
+      }
+      job->Help();
+    }
+  }
+
+  std::mutex mutex_;
+  std::condition_variable has_jobs_;
+  std::deque<std::shared_ptr<Job> > jobs_;
+  std::vector<std::thread> threads_;
+  bool stopping_ = false;
+};
+
+}  // namespace
+
+size_t DefaultThreadsCount() {
+  return std::max(1u, std::thread::hardware_concurrency());
+}
+
+void ParallelFor(size_t n, size_t num_threads,
+                 const std::function<void(size_t)>& body) {
+  ParallelFor(n, num_threads, [&body](size_t i, size_t) { body(i); });
+}
+
+void ParallelFor(size_t n, size_t num_threads,
+                 const std::function<void(size_t, size_t)>& body) {
+  if (num_threads == 0)
+    num_threads = DefaultThreadsCount();
+  num_threads = std::min(num_threads, n);
+  if (num_threads <= 1) {
+    for (size_t i = 0; i < n; i++)
+      body(i, 0);
+    return;
+  }
+
+  const std::shared_ptr<Job> job =
+      std::make_shared<Job>(n, num_threads, body);
+  WorkerPool::Instance().Submit(job, num_threads - 1);
+  job->Run(0);
+  job->Close();
+  if (job->exception)
+    std::rethrow_exception(job->exception);
+}
+
+}  // geom
@@ -0,0 +1,30 @@
+#ifndef PARALLEL_FOR_H
+#define PARALLEL_FOR_H
+
+#include <cstddef>
+#include <functional>
+
+namespace geom {
+
+// std::thread::hardware_concurrency() but at least 1
+size_t DefaultThreadsCount();
+
+// Calls body(i) for every i in [0, n) using num_threads threads
+// (0 means DefaultThreadsCount()), the calling thread is one of them
+// Each thread owns a contiguous range of indices and when it's done
+// steals the second half of the biggest range left to the others
+// so tasks of very different cost are still balanced
+// The other threads come from a process-wide pool started on demand,
+// so repeated calls don't start threads, and nested calls are allowed
+// The first exception thrown by body is rethrown after all threads stop
+void ParallelFor(size_t n, size_t num_threads,
+                 const std::function<void(size_t)>& body);
+// Same, body(i, thread) also gets the index of the calling thread
+// in [0, min(num_threads, n)), so the threads may keep state of their own
+// (e.g. a TriangulationContext) in an array
+void ParallelFor(size_t n, size_t num_threads,
+                 const std::function<void(size_t, size_t)>& body);
+
+}  // geom
+
+#endif  // PARALLEL_FOR_H
@@ -1,100 +1,178 @@
 #include <polygon2d.h>
 
+#include <vertex_kernels.h>
+
+#include <algorithm>
+
 namespace geom {
 
-Polygon2D::Polygon2D(const std::vector<Point2D>& points) {
-  if (points.size() == 0)
-    return;
-  
-  vertices_.push_back(Vertex(points[0]));
-  Vertex* prev = &vertices_.back();
-  for (size_t i = 1; i < points.size(); i++) {
-    if (DoubleEqual(points[i], prev->point))
-      continue;
-    vertices_.push_back(Vertex(points[i]));
-    Vertex* current = &vertices_.back();
-    current->prev = prev;
-    prev->next = current;
-    prev = current;
+RingCoordinates::RingCoordinates(std::pmr::memory_resource* memory) :
+    x_(memory), y_(memory) {}
+
+RingCoordinates::RingCoordinates(const RingCoordinates& other,
+                                 std::pmr::memory_resource* memory) :
+    x_(other.x_, memory), y_(other.y_, memory) {}
+
+void RingCoordinates::Reserve(size_t size) {
+  x_.reserve(size + 2);
+  y_.reserve(size + 2);
+}
+
+// Front padding is added with the first point
+void RingCoordinates::PushBack(const Point2D& point) {
+  if (x_.empty()) {
+    x_.push_back(0);
+    y_.push_back(0);
   }
-  Vertex* first = &vertices_.front();
-  Vertex* last = &vertices_.back();
-  first->prev = last;
-  last->next = first;
+  x_.push_back(point.x);
+  y_.push_back(point.y);
+}
 
+void RingCoordinates::Close() {
+  if (x_.empty())
+    return;
+  x_.front() = x_.back();
+  y_.front() = y_.back();
+  x_.push_back(x_[1]);
+  y_.push_back(y_[1]);
+}
+
+void RingCoordinates::Reverse() {
+  const size_t size = Size();
+  if (size < 3)
+    return;
+  std::reverse(x_.begin() + 2, x_.begin() + size + 1);
+  std::reverse(y_.begin() + 2, y_.begin() + size + 1);
+  x_.front() = x_[size];
+  y_.front() = y_[size];
+}
+
+size_t RingCoordinates::Size() const {
+  return x_.size() < 2 ? 0 : x_.size() - 2;
+}
+
+Polygon2D::Polygon2D(const std::vector<Point2D>& points,
+                     std::pmr::memory_resource* memory) :
+    Polygon2D(memory) {
+  AppendRing(points.data(), points.data() + points.size(), nullptr, 0);
   NormalizeDirection();
   SetVertexTypes();
 }
 
+Polygon2D::Polygon2D(const Polygon2D& other) :
+    Polygon2D(other, std::pmr::get_default_resource()) {}
+
+Polygon2D::Polygon2D(const Polygon2D& other,
+                     std::pmr::memory_resource* memory) :
+    ring_(other.ring_, memory), types_(other.types_, memory),
+    ids_(other.ids_, memory) {}
+
+template<class InputPoint>
+Polygon2D Polygon2D::FromRing(const InputPoint* first,
+                              const InputPoint* last,
+                              std::pmr::memory_resource* memory,
+                              uint32_t first_id) {
+  Polygon2D polygon(memory);
+  polygon.AppendRing(first, last, nullptr, first_id);
+  polygon.NormalizeDirection();
+  polygon.SetVertexTypes();
+  return polygon;
+}
 
-size_t Polygon2D::Size() const {
-  return vertices_.size();
-}
-
-const Polygon2D::Vertex* Polygon2D::GetAnyVertex() const {
-  if (Size() > 0)
-    return &vertices_.front();
-  return nullptr;
-}
-
-Polygon2D::VertexType Polygon2D::GetVertexType(const Vertex* vertex) {
-  const Point2D prev = vertex->prev->point;
-  const Point2D current = vertex->point;
-  const Point2D next = vertex->next->point;
-  const bool start_kind = YFirstPoint2DComparator()(prev, current) &&
-                          YFirstPoint2DComparator()(next, current);
-  const bool end_kind = YFirstPoint2DComparator()(current, prev) &&
-                        YFirstPoint2DComparator()(current, next);
-  if (start_kind || end_kind) {
-    if (MoreThenPiAngle2D({current, prev}, {current, next}))
-      if (start_kind)
-        return SPLIT;
-      else
-        return MERGE;
-    else
-      if (start_kind)
-        return START;
-      else
-        return END;
-  }
-  else {
-    if (YFirstPoint2DComparator()(current, next))
-      return LEFT_REGULAR;
-    return RIGHT_REGULAR;
-  }
+template<class InputPoint>
+Polygon2D Polygon2D::FromClockwiseRing(const InputPoint* first,
+                                       const InputPoint* last,
+                                       std::pmr::memory_resource* memory,
+                                       uint32_t first_id) {
+  Polygon2D polygon(memory);
+  polygon.AppendRing(first, last, nullptr, first_id);
+  polygon.SetVertexTypes();
+  return polygon;
 }
 
-void Polygon2D::SetVertexTypes() {
-  if (Size() == 0)
-    return;
+Polygon2D Polygon2D::FromClockwiseRing(const Point2D* first,
+                                       const Point2D* last,
+                                       const uint32_t* ids,
+                                       std::pmr::memory_resource* memory) {
+  Polygon2D polygon(memory);
+  polygon.AppendRing(first, last, ids, 0);
+  polygon.SetVertexTypes();
+  return polygon;
+}
 
-  Vertex* current = &vertices_.front();
-  for (size_t i = 0; i < Size(); i++, current = current->next)
-    current->type = GetVertexType(current);
+template<class InputPoint>
+Polygon2D Polygon2D::FromCounterclockwiseRing(
+    const InputPoint* first,
+    const InputPoint* last,
+    std::pmr::memory_resource* memory,
+    uint32_t first_id) {
+  Polygon2D polygon(memory);
+  polygon.AppendRing(first, last, nullptr, first_id);
+  polygon.ReverseDirection();
+  polygon.SetVertexTypes();
+  return polygon;
 }
 
-void Polygon2D::ReverseDirection() {
-  if (Size() == 0)
+template<class InputPoint>
+Polygon2D Polygon2D::HoleFromRing(const InputPoint* first,
+                                  const InputPoint* last,
+                                  std::pmr::memory_resource* memory,
+                                  uint32_t first_id) {
+  Polygon2D polygon(memory);
+  polygon.AppendRing(first, last, nullptr, first_id);
+  if (polygon.IsClockwise())
+    polygon.ReverseDirection();
+  polygon.SetVertexTypes();
+  return polygon;
+}
+
+// Points are converted right into the coordinate arrays,
+// so rings of float and int32 aren't widened to a copy first
+// Repeated consecutive points are merged, the first one is kept
+template<class InputPoint>
+void Polygon2D::AppendRing(const InputPoint* first, const InputPoint* last,
+                           const uint32_t* ids, uint32_t first_id) {
+  if (first == last)
     return;
 
-  Vertex* current = &vertices_.front();
-  for (size_t i = 0; i < Size(); i++, current = current->next)
-    std::swap(current->prev, current->next);
+  ring_.Reserve(last - first);
+  ids_.reserve(last - first);
+  auto Id = [&](const InputPoint* input_point) {
+    const uint32_t i = static_cast<uint32_t>(input_point - first);
+    return ids ? ids[i] : first_id + i;
+  };
+  Point2D prev = ToPoint2D(*first);
+  ring_.PushBack(prev);
+  ids_.push_back(Id(first));
+  for (const InputPoint* input_point = first + 1; input_point != last;
+       input_point++) {
+    const Point2D point = ToPoint2D(*input_point);
+    if (DoubleEqual(point, prev))
+      continue;
+    ring_.PushBack(point);
+    ids_.push_back(Id(input_point));
+    prev = point;
+  }
+  ring_.Close();
+}
+
+size_t Polygon2D::Size() const {
+  return ring_.Size();
+}
+
+void Polygon2D::SetVertexTypes() {
+  types_.resize(Size());
+  ClassifyVertices(ring_, 0, Size(), types_.data());
+}
+
+void Polygon2D::ReverseDirection() {
+  ring_.Reverse();
+  if (ids_.size() >= 3)
+    std::reverse(ids_.begin() + 1, ids_.end());
 }
 
 bool Polygon2D::IsClockwise() const {
-  if (Size() == 0)
-    return false;
-
-  const Vertex* current = GetAnyVertex();
-  long double area = 0;
-  for (size_t i = 0; i < Size(); i++) {
-    const Vertex* next = current->next;
-    area += (next->point.x - current->point.x) *
-            (next->point.y + current->point.y);
-    current = next;
-  }
-  return area > 0;
+  return DoubleSignedArea(ring_) < 0;
 }
 
 void Polygon2D::NormalizeDirection() {
@@ -102,38 +180,42 @@ void Polygon2D::NormalizeDirection() {
     ReverseDirection();
 }
 
-bool YFirstVertexComparator::operator()(
-    const Polygon2D::Vertex* const& lhv,
-    const Polygon2D::Vertex* const& rhv) const {
-  if (lhv->point != rhv->point)
-    return YFirstPoint2DComparator()(lhv->point, rhv->point);
-  if (lhv->type != rhv->type)
-    return lhv->type < rhv->type;
-  if (lhv->prev != rhv->prev)
-    return lhv->prev < rhv->prev;
-  return lhv->next < rhv->next;
+bool YFirstVertexComparator::operator()(size_t lhv, size_t rhv) const {
+  if (y_[lhv] != y_[rhv])
+    return y_[lhv] < y_[rhv];
+  if (x_[lhv] != x_[rhv])
+    return x_[lhv] > x_[rhv];
+  if (types_[lhv] != types_[rhv])
+    return types_[lhv] < types_[rhv];
+  return lhv < rhv;
 }
 
 std::vector<Point2D> AsVector(const Polygon2D& polygon) {
-  if (polygon.Size() == 0)
-    return {};
-  
   std::vector<Point2D> result;
-  const Polygon2D::Vertex* current = polygon.GetAnyVertex();
-  for (size_t i = 0; i < polygon.Size(); i++, current = current->next)
-    result.push_back(current->point);
+  result.reserve(polygon.Size());
+  for (size_t i = 0; i < polygon.Size(); i++)
+    result.push_back(polygon.Point(i));
   return result;
 }
 
-std::vector<const Polygon2D::Vertex*> AsVertexVector(const Polygon2D& polygon) {
-  if (polygon.Size() == 0)
-    return {};
-  
-  std::vector<const Polygon2D::Vertex*> result;
-  const Polygon2D::Vertex* current = polygon.GetAnyVertex();
-  for (size_t i = 0; i < polygon.Size(); i++, current = current->next)
-    result.push_back(current);
-  return result;
-}
+#define INSTANTIATE_RING_FACTORIES(T) \
+  template Polygon2D Polygon2D::FromRing( \
+      const BasicPoint2D<T>*, const BasicPoint2D<T>*, \
+      std::pmr::memory_resource*, uint32_t); \
+  template Polygon2D Polygon2D::FromClockwiseRing( \
+      const BasicPoint2D<T>*, const BasicPoint2D<T>*, \
+      std::pmr::memory_resource*, uint32_t); \
+  template Polygon2D Polygon2D::FromCounterclockwiseRing( \
+      const BasicPoint2D<T>*, const BasicPoint2D<T>*, \
+      std::pmr::memory_resource*, uint32_t); \
+  template Polygon2D Polygon2D::HoleFromRing( \
+      const BasicPoint2D<T>*, const BasicPoint2D<T>*, \
+      std::pmr::memory_resource*, uint32_t);
+
+INSTANTIATE_RING_FACTORIES(float)
+INSTANTIATE_RING_FACTORIES(double)
+INSTANTIATE_RING_FACTORIES(int32_t)
+
+#undef INSTANTIATE_RING_FACTORIES
 
 }  // geom
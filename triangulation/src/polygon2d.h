@@ -3,13 +3,64 @@
 
 #include <geom_utils.h>
 
+#include <cstdint>
 #include <functional>
-#include <list>
+#include <memory_resource>
 #include <vector>
 
 namespace geom {
 
+// Ring coordinates as a structure of arrays
+// Vertex i is at i + 1, the last vertex is repeated in front
+// and the first one at the back, so previous, current and next vertices
+// are read as three arrays shifted by one (see vertex_kernels.h)
+class RingCoordinates {
+ public:
+  explicit RingCoordinates(std::pmr::memory_resource* memory =
+                               std::pmr::get_default_resource());
+  RingCoordinates(const RingCoordinates& other,
+                  std::pmr::memory_resource* memory);
+  RingCoordinates(const RingCoordinates& other) = default;
+  RingCoordinates(RingCoordinates&& other) = default;
+  RingCoordinates& operator=(const RingCoordinates& other) = default;
+  RingCoordinates& operator=(RingCoordinates&& other) = default;
+
+  void Reserve(size_t size);
+  void PushBack(const Point2D& point);
+  // Fills the padding, called after the last PushBack
+  void Close();
+  // Same ring in the opposite direction starting at the same vertex
+  void Reverse();
+
+  size_t Size() const;
+  Point2D Point(size_t i) const { return {x_[i + 1], y_[i + 1]}; }
+  const double* X() const { return x_.data(); }
+  const double* Y() const { return y_.data(); }
+
+ private:
+  std::pmr::vector<double> x_;
+  std::pmr::vector<double> y_;
+};
+
+// Vertex made of an input point keeps the index of the point
+// in the input as its id (ring factories number the points from first_id),
+// vertices added at resolved self-intersections get ids with this bit set,
+// numbered from zero
+constexpr uint32_t kAddedVertexId = 1u << 31;
+
+// Triangle given by vertex indices of a polygon
+struct VertexTriangle {
+  uint32_t a;
+  uint32_t b;
+  uint32_t c;
+};
+
 // Simple polygon representation
+// Vertices are stored in ring order as arrays of coordinates, types
+// and ids allocated from the given memory resource,
+// so a vertex is its index and its neighbours are the adjacent indices
+// The ring is clockwise unless it's made by FromCounterclockwiseRing
+// or HoleFromRing
 
 class Polygon2D {
  public:
@@ -22,39 +73,117 @@ class Polygon2D {
     RIGHT_REGULAR
   };
 
-  struct Vertex {
-    const Point2D point;
-    Vertex* prev;
-    Vertex* next;
-    VertexType type;
-
-    explicit Vertex(const Point2D& point) : point(point) {}
-  };
-
-  explicit Polygon2D(const std::vector<Point2D>& points);
+  explicit Polygon2D(const std::vector<Point2D>& points,
+                     std::pmr::memory_resource* memory =
+                         std::pmr::get_default_resource());
+  Polygon2D(const Polygon2D& other);
+  Polygon2D(const Polygon2D& other, std::pmr::memory_resource* memory);
+  Polygon2D(Polygon2D&& other) = default;
+  Polygon2D& operator=(const Polygon2D& other) = default;
+  Polygon2D& operator=(Polygon2D&& other) = default;
+
+  // Ring factories take points of any coordinate type of BasicPoint2D,
+  // they are converted to double exactly
+
+  // Same as the constructor
+  template<class InputPoint>
+  static Polygon2D FromRing(const InputPoint* first,
+                            const InputPoint* last,
+                            std::pmr::memory_resource* memory =
+                                std::pmr::get_default_resource(),
+                            uint32_t first_id = 0);
+  // For rings already known to be clockwise
+  // Skips direction normalization pass
+  template<class InputPoint>
+  static Polygon2D FromClockwiseRing(const InputPoint* first,
+                                     const InputPoint* last,
+                                     std::pmr::memory_resource* memory =
+                                         std::pmr::get_default_resource(),
+                                     uint32_t first_id = 0);
+  // Clockwise ring of vertices with known ids (e.g. DcelPolygon2D faces)
+  static Polygon2D FromClockwiseRing(const Point2D* first,
+                                     const Point2D* last,
+                                     const uint32_t* ids,
+                                     std::pmr::memory_resource* memory);
+  template<class InputPoint>
+  static Polygon2D FromCounterclockwiseRing(
+      const InputPoint* first,
+      const InputPoint* last,
+      std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+      uint32_t first_id = 0);
+
+  // Hole ring of a polygon with holes is kept counterclockwise,
+  // so the polygon is on the same side of its edges as of the outer ring
+  // and vertex types are the ones of the polygon (top of a hole is SPLIT)
+  template<class InputPoint>
+  static Polygon2D HoleFromRing(const InputPoint* first,
+                                const InputPoint* last,
+                                std::pmr::memory_resource* memory =
+                                    std::pmr::get_default_resource(),
+                                uint32_t first_id = 0);
 
   size_t Size() const;
 
-  const Vertex* GetAnyVertex() const;
+  Point2D Point(size_t vertex) const { return ring_.Point(vertex); }
+  VertexType Type(size_t vertex) const { return types_[vertex]; }
+  uint32_t Id(size_t vertex) const { return ids_[vertex]; }
+  Triangle2D Triangle(const VertexTriangle& triangle) const {
+    return Triangle2D(Point(triangle.a), Point(triangle.b),
+                      Point(triangle.c));
+  }
+  size_t Next(size_t vertex) const {
+    return vertex + 1 == Size() ? 0 : vertex + 1;
+  }
+  size_t Prev(size_t vertex) const {
+    return vertex == 0 ? Size() - 1 : vertex - 1;
+  }
+
+  // Arrays of Size() elements
+  const double* X() const { return ring_.X() + 1; }
+  const double* Y() const { return ring_.Y() + 1; }
+  const VertexType* Types() const { return types_.data(); }
 
  private:
-  static VertexType GetVertexType(const Vertex* vertex);
+  explicit Polygon2D(std::pmr::memory_resource* memory) :
+      ring_(memory), types_(memory), ids_(memory) {}
+
+  // Ids are taken from ids if it's given
+  // and counted from first_id otherwise
+  template<class InputPoint>
+  void AppendRing(const InputPoint* first, const InputPoint* last,
+                  const uint32_t* ids, uint32_t first_id);
+
   void SetVertexTypes();
 
   void ReverseDirection();
   bool IsClockwise() const;
   void NormalizeDirection();
 
-  std::list<Vertex> vertices_;
+  RingCoordinates ring_;
+  std::pmr::vector<VertexType> types_;
+  std::pmr::vector<uint32_t> ids_;
 };
 
-struct YFirstVertexComparator {
-  bool operator()(const Polygon2D::Vertex* const& lhv,
-                  const Polygon2D::Vertex* const& rhv) const;
+// Sweep order of vertices given by indices into coordinate and type arrays
+// (e.g. of Polygon2D), vertices at the same point are ordered by type
+// and then by index
+class YFirstVertexComparator {
+ public:
+  YFirstVertexComparator(const double* x, const double* y,
+                         const Polygon2D::VertexType* types) :
+      x_(x), y_(y), types_(types) {}
+  explicit YFirstVertexComparator(const Polygon2D& polygon) :
+      YFirstVertexComparator(polygon.X(), polygon.Y(), polygon.Types()) {}
+
+  bool operator()(size_t lhv, size_t rhv) const;
+
+ private:
+  const double* x_;
+  const double* y_;
+  const Polygon2D::VertexType* types_;
 };
 
 std::vector<Point2D> AsVector(const Polygon2D& polygon);
-std::vector<const Polygon2D::Vertex*> AsVertexVector(const Polygon2D& polygon);
 
 }  // geom
 
@@ -0,0 +1,262 @@
+#include <polygon_shape.h>
+
+#include <geom_utils.h>
+#include <segments_on_y_sweep_line.h>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace geom {
+
+namespace {
+
+// Walks both chains from the START vertex down to the END vertex
+// comparing every vertex with the edge of the opposite chain at its y
+// Chains are separated if one of them is strictly to the left all the way
+// Horizontal edges make x at y ambiguous, such polygons aren't accepted
+// Sides are found exactly by orientation against the edge going up
+bool AreChainsSeparated(const Polygon2D& polygon, size_t start) {
+  size_t a_prev = start;
+  size_t a = polygon.Next(start);
+  size_t b_prev = start;
+  size_t b = polygon.Prev(start);
+  int side = 0;
+  while (a != b) {
+    const bool a_higher =
+        YFirstPoint2DComparator()(polygon.Point(b), polygon.Point(a));
+    const size_t vertex = a_higher ? a : b;
+    const Point2D edge_high = polygon.Point(a_higher ? b_prev : a_prev);
+    const Point2D edge_low = polygon.Point(a_higher ? b : a);
+    if (edge_high.y == edge_low.y)
+      return false;
+
+    // Positive when the vertex is to the left of the edge
+    const int turn = Orient2D(edge_low, edge_high, polygon.Point(vertex));
+    if (turn == 0)
+      return false;
+    // Side of the a chain relative to the b chain
+    const int vertex_side = (turn > 0) == a_higher ? -1 : 1;
+    if (side != 0 && vertex_side != side)
+      return false;
+    side = vertex_side;
+
+    if (a_higher) {
+      a_prev = a;
+      a = polygon.Next(a);
+    } else {
+      b_prev = b;
+      b = polygon.Prev(b);
+    }
+  }
+  return true;
+}
+
+// Closed segments, touching counts as intersection
+bool SegmentsIntersect(const Segment2D& lhs, const Segment2D& rhs) {
+  const int lhs_a = Orient2D(rhs.a, rhs.b, lhs.a);
+  const int lhs_b = Orient2D(rhs.a, rhs.b, lhs.b);
+  const int rhs_a = Orient2D(lhs.a, lhs.b, rhs.a);
+  const int rhs_b = Orient2D(lhs.a, lhs.b, rhs.b);
+  if (lhs_a * lhs_b < 0 && rhs_a * rhs_b < 0)
+    return true;
+  return (lhs_a == 0 && InBoundingBox(rhs, lhs.a)) ||
+         (lhs_b == 0 && InBoundingBox(rhs, lhs.b)) ||
+         (rhs_a == 0 && InBoundingBox(lhs, rhs.a)) ||
+         (rhs_b == 0 && InBoundingBox(lhs, rhs.b));
+}
+
+// Adjacent edges share a vertex, they only may go back along each other
+bool AdjacentEdgesOverlap(const Point2D& prev, const Point2D& current,
+                          const Point2D& next) {
+  const Vector2D in(prev, current);
+  const Vector2D out(current, next);
+  return Orient2D(prev, current, next) == 0 &&
+         in.x * out.x + in.y * out.y < 0;
+}
+
+// Edge of one of the rings, segment goes from its lower end up
+struct RingEdge {
+  Segment2D segment;
+  uint32_t ring;
+  // Whether the ring goes up along the edge
+  bool up;
+};
+
+struct RingEvent {
+  Point2D point;
+  bool begin;
+  uint32_t edge;
+};
+
+}  // namespace
+
+PolygonShape ClassifyPolygon(const Polygon2D& polygon, bool known_simple) {
+  if (polygon.Size() < 3)
+    return UNKNOWN_SHAPE;
+
+  size_t starts = 0, ends = 0;
+  size_t start = 0;
+  bool left_turns = false, right_turns = false, straight = false;
+  for (size_t i = 0; i < polygon.Size(); i++) {
+    switch (polygon.Type(i)) {
+      case Polygon2D::START:
+        starts++;
+        start = i;
+        break;
+      case Polygon2D::END:
+        ends++;
+        break;
+      case Polygon2D::SPLIT:
+      case Polygon2D::MERGE:
+        return UNKNOWN_SHAPE;
+      default:
+        break;
+    }
+    // Repeated vertex pinches the ring, leave it to the full pipeline
+    const Point2D current = polygon.Point(i);
+    const Point2D next = polygon.Point(polygon.Next(i));
+    if (DoubleEqual(current, next))
+      return UNKNOWN_SHAPE;
+    const int turn = Orient2D(polygon.Point(polygon.Prev(i)), current, next);
+    left_turns |= turn > 0;
+    right_turns |= turn < 0;
+    straight |= turn == 0;
+  }
+  if (starts != 1 || ends != 1)
+    return UNKNOWN_SHAPE;
+
+  if (!straight && left_turns != right_turns)
+    return CONVEX;
+  if (known_simple || AreChainsSeparated(polygon, start))
+    return SIMPLE_Y_MONOTONE;
+  return UNKNOWN_SHAPE;
+}
+
+bool IsSimpleYMonotone(const Polygon2D& polygon) {
+  return ClassifyPolygon(polygon) != UNKNOWN_SHAPE;
+}
+
+bool IsSimpleBruteForce(const Polygon2D& polygon) {
+  const size_t size = polygon.Size();
+  if (size < 3)
+    return false;
+
+  for (size_t i = 0; i < size; i++) {
+    const Point2D current = polygon.Point(i);
+    const Point2D next = polygon.Point(polygon.Next(i));
+    if (DoubleEqual(current, next) ||
+        AdjacentEdgesOverlap(polygon.Point(polygon.Prev(i)), current, next))
+      return false;
+    const Segment2D edge(current, next);
+    // Edges before this one were already checked against it,
+    // the last edge is adjacent to the first one
+    for (size_t j = i + 2; j < size && (i != 0 || j + 1 != size); j++) {
+      if (SegmentsIntersect(edge, {polygon.Point(j),
+                                   polygon.Point(polygon.Next(j))}))
+        return false;
+    }
+  }
+  return true;
+}
+
+// Intersections are found by Shamos-Hoey sweep: the first one
+// to come is between segments neighbouring on the sweep line
+// Repeated vertices are found apart by sorting, so edges sharing
+// an end are adjacent edges of a ring and may only overlap
+// Polygon is clockwise and holes are counterclockwise, so the inside
+// of the polygon with holes is to the right of every edge,
+// to the east of the edges going up
+// Every ring starts at its lowest vertex, the hole is in place
+// if the first edge to the left of it goes up
+std::optional<RingsDefect> CheckPolygonWithHoles(
+    const Polygon2D& polygon,
+    const std::pmr::vector<Polygon2D>& holes,
+    std::pmr::memory_resource* memory) {
+  auto Ring = [&](size_t ring) -> const Polygon2D& {
+    return ring == 0 ? polygon : holes[ring - 1];
+  };
+  const size_t rings = holes.size() + 1;
+
+  std::pmr::vector<Point2D> points(memory);
+  std::pmr::vector<RingEdge> edges(memory);
+  for (size_t ring = 0; ring < rings; ring++) {
+    const Polygon2D& ring_polygon = Ring(ring);
+    for (size_t i = 0; i < ring_polygon.Size(); i++) {
+      const Point2D current = ring_polygon.Point(i);
+      const Point2D next = ring_polygon.Point(ring_polygon.Next(i));
+      if (AdjacentEdgesOverlap(ring_polygon.Point(ring_polygon.Prev(i)),
+                               current, next))
+        return RingsDefect{RingsDefect::INTERSECTION, current, 0};
+      points.push_back(current);
+      const bool up = YFirstPoint2DComparator()(current, next);
+      edges.push_back({up ? Segment2D(current, next)
+                          : Segment2D(next, current),
+                       static_cast<uint32_t>(ring), up});
+    }
+  }
+
+  std::sort(points.begin(), points.end(), YFirstPoint2DComparator());
+  const auto repeated = std::adjacent_find(points.begin(), points.end());
+  if (repeated != points.end())
+    return RingsDefect{RingsDefect::INTERSECTION, *repeated, 0};
+
+  std::pmr::vector<RingEvent> events(memory);
+  events.reserve(2 * edges.size());
+  for (uint32_t i = 0; i < edges.size(); i++) {
+    events.push_back({edges[i].segment.a, true, i});
+    events.push_back({edges[i].segment.b, false, i});
+  }
+  // Edges ending at a point leave the sweep line before new ones come
+  std::sort(events.begin(), events.end(),
+            [](const RingEvent& lhe, const RingEvent& rhe) {
+    if (lhe.point != rhe.point)
+      return YFirstPoint2DComparator()(lhe.point, rhe.point);
+    return lhe.begin < rhe.begin;
+  });
+
+  auto Intersection = [](const std::optional<Segment2D>& lhs,
+                         const std::optional<Segment2D>& rhs) {
+    std::optional<Point2D> point;
+    if (!lhs || !rhs || lhs->a == rhs->a || lhs->a == rhs->b ||
+        lhs->b == rhs->a || lhs->b == rhs->b)
+      return point;
+    // Only ends of the second segment are found on a collinear first one
+    point = IntersectionPoint(*lhs, *rhs);
+    if (!point)
+      point = IntersectionPoint(*rhs, *lhs);
+    return point;
+  };
+
+  SegmentsOnYSweepLine segments(memory);
+  std::pmr::vector<bool> ring_started(rings, false, memory);
+  for (const RingEvent& event : events) {
+    segments.SetY(event.point.y);
+    const RingEdge& edge = edges[event.edge];
+    if (!event.begin) {
+      const std::optional<Segment2D> prev = segments.Prev(edge.segment);
+      const std::optional<Segment2D> next = segments.Next(edge.segment);
+      segments.Remove(edge.segment);
+      if (const std::optional<Point2D> point = Intersection(prev, next))
+        return RingsDefect{RingsDefect::INTERSECTION, *point, 0};
+      continue;
+    }
+
+    if (!ring_started[edge.ring]) {
+      ring_started[edge.ring] = true;
+      const std::optional<uint32_t> left = segments.FirstLeftTag(event.point);
+      if (edge.ring != 0 && (!left || !edges[*left].up))
+        return RingsDefect{RingsDefect::MISPLACED_HOLE, event.point,
+                           edge.ring - 1u};
+    }
+    segments.Add(edge.segment, event.edge);
+    for (const std::optional<Segment2D>& neighbour :
+         {segments.Prev(edge.segment), segments.Next(edge.segment)}) {
+      if (const std::optional<Point2D> point =
+              Intersection(edge.segment, neighbour))
+        return RingsDefect{RingsDefect::INTERSECTION, *point, 0};
+    }
+  }
+  return {};
+}
+
+}  // geom
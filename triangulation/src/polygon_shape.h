@@ -0,0 +1,67 @@
+#ifndef POLYGON_SHAPE_H
+#define POLYGON_SHAPE_H
+
+#include <polygon2d.h>
+
+#include <cstddef>
+#include <memory_resource>
+#include <optional>
+#include <vector>
+
+namespace geom {
+
+// Cheap O(N) checks used to skip the stages of the pipeline
+// Built on vertex types computed by Polygon2D
+
+enum PolygonShape {
+  CONVEX,
+  SIMPLE_Y_MONOTONE,
+  UNKNOWN_SHAPE
+};
+
+// Polygon with exactly one START and one END vertex
+// and no SPLIT and MERGE vertices is split into two y-monotone chains
+// It's convex if it turns to the same side at every vertex,
+// otherwise it's simple if the chains don't cross
+// Anything else is reported as UNKNOWN_SHAPE
+// Chains aren't checked when the polygon is known to be simple
+PolygonShape ClassifyPolygon(const Polygon2D& polygon,
+                             bool known_simple = false);
+
+// Chains are checked even for pieces returned by ResolveIntersections,
+// pieces of degenerate inputs may still touch or overlap themselves
+bool IsSimpleYMonotone(const Polygon2D& polygon);
+
+// Pairwise O(N^2) check of the edges, cheaper than the sweep
+// on small polygons only
+// Touching edges and repeated vertices aren't accepted
+bool IsSimpleBruteForce(const Polygon2D& polygon);
+
+// First problem found by CheckPolygonWithHoles
+struct RingsDefect {
+  enum Type {
+    // Edges cross, touch or overlap, or a vertex is repeated
+    INTERSECTION,
+    // Hole is outside the polygon or inside another hole
+    MISPLACED_HOLE
+  };
+
+  Type type;
+  // Point of the intersection or the lowest vertex of the hole
+  Point2D point;
+  // Index of the misplaced hole
+  size_t hole;
+};
+
+// Precondition of DecomposeToYMonotones on a polygon with holes:
+// rings are simple and don't touch each other, holes are inside
+// the polygon and outside each other
+// Checked by one O(NlogN) sweep over the edges of all the rings
+std::optional<RingsDefect> CheckPolygonWithHoles(
+    const Polygon2D& polygon,
+    const std::pmr::vector<Polygon2D>& holes,
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+}  // geom
+
+#endif  // POLYGON_SHAPE_H
@@ -3,15 +3,20 @@
 #include <dcel_polygon2d.h>
 #include <segments_on_y_sweep_line.h>
 
+#include <algorithm>
 #include <cassert>
-#include <memory>
+#include <cstdint>
+#include <memory_resource>
 #include <optional>
-#include <set>
+#include <utility>
+#include <vector>
 
 namespace geom {
 
 namespace {
 
+// Value type, so events are kept in flat arrays without
+// an allocation per event
 struct Event {
   enum EventType {
     BEGIN = 0,
@@ -19,86 +24,86 @@ struct Event {
     END = 2
   };
 
-  const Point2D point;
-  const EventType type;
-
- protected:
-  Event(const Point2D& point, const EventType type) :
-      point(point), type(type) {}
-};
-
-struct BeginEvent : public Event {
-  const Segment2D segment;
-  BeginEvent(const Segment2D& segment) :
-      Event(segment.a, BEGIN), segment(segment) {}
-};
+  Point2D point;
+  EventType type;
+  // Segment of BEGIN and END events,
+  // ends of both intersected segments for INTERSECTION events
+  Segment2D segment;
+  // Number of the EventManager push which added the event,
+  // zero for the events of the polygon edges
+  uint32_t sequence = 0;
+
+  static Event Begin(const Segment2D& segment) {
+    return {segment.a, BEGIN, segment};
+  }
 
-struct EndEvent : public Event {
-  const Segment2D segment;
-  EndEvent(const Segment2D& segment) :
-      Event(segment.b, END), segment(segment) {}
-};
+  static Event End(const Segment2D& segment) {
+    return {segment.b, END, segment};
+  }
 
-struct IntersectionEvent : public Event {
-  const Point2D a_end;
-  const Point2D b_end;
-  IntersectionEvent(const Point2D& point,
-                    const Point2D& a_end,
-                    const Point2D& b_end) :
-      Event(point, INTERSECTION), a_end(a_end), b_end(b_end) {}
+  static Event Intersection(const Point2D& point,
+                            const Point2D& a_end,
+                            const Point2D& b_end) {
+    return {point, INTERSECTION, {a_end, b_end}};
+  }
 };
 
 bool YFirstSegmentLess(const Segment2D& lhs, const Segment2D& rhs) {
-  if (DoubleEqual(lhs.a, rhs.a))
+  if (lhs.a == rhs.a)
     return YFirstPoint2DComparator()(lhs.b, rhs.b);
   return YFirstPoint2DComparator()(lhs.a, rhs.a);
 }
 
-struct EventComparator {
-  bool operator()(const std::unique_ptr<const Event>& lhe,
-                  const std::unique_ptr<const Event>& rhe) const {
-    if (DoubleEqual(lhe->point, rhe->point)) {
-      if (lhe->type == rhe->type) {
-        switch (lhe->type) {
-          case Event::BEGIN: {
-            auto begin_lhe = static_cast<const BeginEvent*>(lhe.get());
-            auto begin_rhe = static_cast<const BeginEvent*>(rhe.get());
-            return YFirstSegmentLess(begin_lhe->segment, begin_rhe->segment);
-          }
-          case Event::END: {
-            auto end_lhe = static_cast<const EndEvent*>(lhe.get());
-            auto end_rhe = static_cast<const EndEvent*>(rhe.get());
-            return YFirstSegmentLess(end_lhe->segment, end_rhe->segment);
-          }
-          case Event::INTERSECTION: {
-            auto int_lhe = static_cast<const IntersectionEvent*>(lhe.get());
-            auto int_rhe = static_cast<const IntersectionEvent*>(rhe.get());
-            if (DoubleEqual(int_lhe->a_end, int_rhe->a_end))
-              return YFirstPoint2DComparator()(int_lhe->b_end, int_rhe->b_end);
-            else
-              return YFirstPoint2DComparator()(int_lhe->a_end, int_rhe->a_end);
-          }
-        }
-      }
-      return lhe->type > rhe->type;
-    }
-    return YFirstPoint2DComparator()(lhe->point, rhe->point);
+bool EventLess(const Event& lhe, const Event& rhe) {
+  if (lhe.point == rhe.point) {
+    if (lhe.type == rhe.type)
+      return YFirstSegmentLess(lhe.segment, rhe.segment);
+    return lhe.type > rhe.type;
   }
-};
+  return YFirstPoint2DComparator()(lhe.point, rhe.point);
+}
 
+bool EventEquivalent(const Event& lhe, const Event& rhe) {
+  return !EventLess(lhe, rhe) && !EventLess(rhe, lhe);
+}
+
+// Events of the polygon edges are known in advance,
+// so they are sorted once into a flat array,
+// only events found during the sweep go to a binary heap
+// Removed events go to a heap of their own and hide the same event
+// pushed before the removal when they meet at the top
 class EventManager {
  public:
-  const Event* Top() const {
-    assert(!events_.empty());
-    return events_.begin()->get();
-  }
-
-  bool Empty() const {
-    return events_.empty();
+  EventManager(const Polygon2D& polygon, std::pmr::memory_resource* memory) :
+      sorted_(memory), next_sorted_(0), found_(memory), removed_(memory),
+      pushes_(0) {
+    sorted_.reserve(2 * polygon.Size());
+    for (size_t i = 0; i < polygon.Size(); i++) {
+      Point2D a = polygon.Point(i), b = polygon.Point(polygon.Next(i));
+      if (!YFirstPoint2DComparator()(a, b))
+        std::swap(a, b);
+      sorted_.push_back(Event::Begin({a, b}));
+      sorted_.push_back(Event::End({a, b}));
+    }
+    std::stable_sort(sorted_.begin(), sorted_.end(), EventLess);
+    sorted_.erase(
+        std::unique(sorted_.begin(), sorted_.end(), EventEquivalent),
+        sorted_.end());
   }
 
-  void Pop() {
-    events_.erase(events_.begin());
+  // Takes the next event, returns false when there are no events left
+  bool Pop(Event* event) {
+    while (PopAny(event)) {
+      // Equivalent events are one event, pushed with the last of them
+      while (HasAny() && EventEquivalent(Top(), *event)) {
+        Event same;
+        PopAny(&same);
+        event->sequence = std::max(event->sequence, same.sequence);
+      }
+      if (event->type == Event::INTERSECTION || !PopRemoved(*event))
+        return true;
+    }
+    return false;
   }
 
   void AddSegment(const Segment2D& segment) {
@@ -107,54 +112,109 @@ class EventManager {
   }
 
   void RemoveSegment(const Segment2D& segment) {
-    RemoveBegin(segment);
-    RemoveEnd(segment);
+    Remove(Event::Begin(segment));
+    Remove(Event::End(segment));
   }
 
   void AddBegin(const Segment2D& segment) {
-    events_.insert(std::make_unique<const BeginEvent>(segment));
+    Push(Event::Begin(segment));
   }
 
   void AddEnd(const Segment2D& segment) {
-    events_.insert(std::make_unique<const EndEvent>(segment));
+    Push(Event::End(segment));
   }
 
   void AddIntersection(
       const Point2D& point, const Point2D& a_end, const Point2D& b_end) {
-    events_.insert(std::make_unique<const IntersectionEvent>(
-        point, a_end, b_end));
+    Push(Event::Intersection(point, a_end, b_end));
   }
 
-  void RemoveBegin(const Segment2D& segment) {
-    events_.erase(std::make_unique<const BeginEvent>(segment));
+ private:
+  static bool EventGreater(const Event& lhe, const Event& rhe) {
+    return EventLess(rhe, lhe);
   }
 
-  void RemoveEnd(const Segment2D& segment) {
-    events_.erase(std::make_unique<const EndEvent>(segment));
+  bool HasAny() const {
+    return next_sorted_ < sorted_.size() || !found_.empty();
   }
 
- private:
-  std::set<std::unique_ptr<const Event>, EventComparator> events_;
-};
+  bool SortedFirst() const {
+    return next_sorted_ < sorted_.size() &&
+        (found_.empty() || !EventLess(found_.front(), sorted_[next_sorted_]));
+  }
 
-}  // namespace
+  const Event& Top() const {
+    assert(HasAny());
+    return SortedFirst() ? sorted_[next_sorted_] : found_.front();
+  }
 
-std::list<Polygon2D> ResolveIntersections(const Polygon2D& polygon) {
-  if (polygon.Size() < 4)
-    return {polygon};
+  bool PopAny(Event* event) {
+    if (!HasAny())
+      return false;
+    if (SortedFirst()) {
+      *event = sorted_[next_sorted_++];
+    } else {
+      std::pop_heap(found_.begin(), found_.end(), EventGreater);
+      *event = found_.back();
+      found_.pop_back();
+    }
+    return true;
+  }
+
+  // Tells if the event was removed after it was pushed the last time
+  // Removals of this event and of the ones already passed are dropped
+  bool PopRemoved(const Event& event) {
+    bool removed = false;
+    while (!removed_.empty() && !EventLess(event, removed_.front())) {
+      if (EventEquivalent(removed_.front(), event) &&
+          removed_.front().sequence >= event.sequence)
+        removed = true;
+      std::pop_heap(removed_.begin(), removed_.end(), EventGreater);
+      removed_.pop_back();
+    }
+    return removed;
+  }
+
+  void Remove(Event event) {
+    event.sequence = pushes_;
+    removed_.push_back(event);
+    std::push_heap(removed_.begin(), removed_.end(), EventGreater);
+  }
+
+  // Event added after removal of the same one is a new event
+  void Push(Event event) {
+    event.sequence = ++pushes_;
+    found_.push_back(event);
+    std::push_heap(found_.begin(), found_.end(), EventGreater);
+  }
 
-  DcelPolygon2D dcel_polygon(polygon);
-  EventManager events;
-  SegmentsOnYSweepLine segments;
+  std::pmr::vector<Event> sorted_;
+  size_t next_sorted_;
+  std::pmr::vector<Event> found_;
+  std::pmr::vector<Event> removed_;
+  uint32_t pushes_;
+};
+
+}  // namespace
 
-  const Polygon2D::Vertex* current = polygon.GetAnyVertex();
-  for (size_t i = 0; i < polygon.Size(); i++, current = current->next) {
-    Point2D a = current->point, b = current->next->point;
-    if (!YFirstPoint2DComparator()(a, b))
-      std::swap(a, b);
-    events.AddSegment({a, b});
+std::pmr::list<Polygon2D> ResolveIntersections(
+    const Polygon2D& polygon,
+    std::pmr::memory_resource* memory,
+    TriangulationStats* stats) {
+  std::pmr::list<Polygon2D> res(memory);
+  if (polygon.Size() < 4) {
+    res.push_back(Polygon2D(polygon, memory));
+    return res;
   }
 
+  // Most of inputs are simple already
+  // so DCEL is built only when the first intersection is found
+  std::optional<DcelPolygon2D> dcel_polygon;
+  EventManager events(polygon, memory);
+  SegmentsOnYSweepLine segments(memory);
+
+  // Returns the point where segment_a is split if it is
+  // Segment touched at its end by the other one isn't split
   auto ResolveIntersection = [&](const Segment2D& segment_a,
                                  const Segment2D& segment_b) {
     std::optional<Point2D> int_point_opt =
@@ -165,82 +225,87 @@ std::list<Polygon2D> ResolveIntersections(const Polygon2D& polygon) {
     if (IsIntersectionOnVertex(segment_a, segment_b))
       return std::optional<Point2D>();
 
-    dcel_polygon.ResolveIntersection(segment_a, segment_b);
-
-    events.RemoveSegment(segment_a);
-    events.RemoveSegment(segment_b);
+    if (!dcel_polygon)
+      dcel_polygon.emplace(polygon, memory, stats);
+    dcel_polygon->ResolveIntersection(segment_a, segment_b);
+    if (stats)
+      stats->intersections++;
 
     const Point2D int_point = int_point_opt.value();
-    const Segment2D a1int = {segment_a.a, int_point};
-    const Segment2D b1int = {segment_b.a, int_point};
-
-    events.AddEnd(a1int);
-    events.AddEnd(b1int);
-
-    events.AddIntersection(int_point, segment_a.b, segment_b.b);
-
-    segments.Remove(segment_a);
-    segments.Remove(segment_b);
-
-    segments.Add(a1int);
-    segments.Add(b1int);
-
+    auto Split = [&](const Segment2D& segment) {
+      if (segment.a == int_point || segment.b == int_point)
+        return false;
+      const Segment2D lower = {segment.a, int_point};
+      events.RemoveSegment(segment);
+      events.AddEnd(lower);
+      segments.Remove(segment);
+      segments.Add(lower);
+      return true;
+    };
+    const bool a_split = Split(segment_a);
+    const bool b_split = Split(segment_b);
+
+    events.AddIntersection(int_point, a_split ? segment_a.b : int_point,
+                           b_split ? segment_b.b : int_point);
+
+    if (!a_split)
+      return std::optional<Point2D>();
     return std::optional<Point2D>(int_point);
   };
 
-  while (!events.Empty()) {
-    const Event* event = events.Top();
-    SegmentsOnYSweepLine::SetY(event->point.y);
+  Event event;
+  while (events.Pop(&event)) {
+    if (stats)
+      stats->events++;
+    segments.SetY(event.point.y);
 
-    switch (event->type) {
+    switch (event.type) {
       case Event::BEGIN: {
-        const BeginEvent begin_event = *(static_cast<const BeginEvent*>(event));
-        events.Pop();
-
-        std::optional<Segment2D> left = segments.FirstLeft(begin_event.segment);
-        std::optional<Segment2D> right =
-            segments.FirstRight(begin_event.segment);
+        std::optional<Segment2D> left = segments.FirstLeft(event.segment);
+        std::optional<Segment2D> right = segments.FirstRight(event.segment);
 
         std::optional<Point2D> int_point;
         if (left)
-          int_point = ResolveIntersection(begin_event.segment, *left);
+          int_point = ResolveIntersection(event.segment, *left);
         if (right && !int_point)
-          int_point = ResolveIntersection(begin_event.segment, *right);
+          int_point = ResolveIntersection(event.segment, *right);
 
         if (int_point)
-          events.AddBegin({begin_event.point, int_point.value()});
+          events.AddBegin({event.point, int_point.value()});
         else
-          segments.Add(begin_event.segment);
+          segments.Add(event.segment);
 
         break;
       }
       case Event::END: {
-        const EndEvent end_event = *(static_cast<const EndEvent*>(event));
-        events.Pop();
+        segments.Remove(event.segment);
 
-        segments.Remove(end_event.segment);
-
-        std::optional<Segment2D> left = segments.FirstLeft(end_event.segment);
-        std::optional<Segment2D> right = segments.FirstRight(end_event.segment);
+        std::optional<Segment2D> left = segments.FirstLeft(event.segment);
+        std::optional<Segment2D> right = segments.FirstRight(event.segment);
         if (left && right)
           ResolveIntersection(*left, *right);
 
         break;
       }
       case Event::INTERSECTION: {
-        const IntersectionEvent int_event =
-            *(static_cast<const IntersectionEvent*>(event));
-        events.Pop();
-
-        events.AddSegment({int_event.point, int_event.a_end});
-        events.AddSegment({int_event.point, int_event.b_end});
+        // Ends of the intersected segments,
+        // the point itself for a segment which wasn't split
+        const Point2D a_end = event.segment.a, b_end = event.segment.b;
+        if (a_end != event.point)
+          events.AddSegment({event.point, a_end});
+        if (b_end != event.point)
+          events.AddSegment({event.point, b_end});
 
         break;
       }
     }
   }
 
-  return dcel_polygon.GetPolygons();
+  if (!dcel_polygon) {
+    res.push_back(Polygon2D(polygon, memory));
+    return res;
+  }
+  return dcel_polygon->GetPolygons();
 }
 
 }  // geom
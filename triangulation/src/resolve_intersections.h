@@ -2,12 +2,17 @@
 #define RESOLVE_INTERSECTIONS_H
 
 #include <polygon2d.h>
+#include <triangulation_stats.h>
 
 #include <list>
+#include <memory_resource>
 
 namespace geom {
 
-std::list<Polygon2D> ResolveIntersections(const Polygon2D& polygon);
+std::pmr::list<Polygon2D> ResolveIntersections(
+    const Polygon2D& polygon,
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+    TriangulationStats* stats = nullptr);
 
 }  // geom
 
@@ -0,0 +1,61 @@
+#include <retaining_memory_resource.h>
+
+namespace geom {
+
+namespace {
+
+constexpr size_t kBlockAlignment = alignof(std::max_align_t);
+
+}  // namespace
+
+RetainingMemoryResource::RetainingMemoryResource(
+    std::pmr::memory_resource* upstream) : upstream_(upstream) {}
+
+RetainingMemoryResource::~RetainingMemoryResource() {
+  for (size_t size_class = 0; size_class < kSizeClasses; size_class++) {
+    FreeBlock* block = free_lists_[size_class];
+    while (block) {
+      FreeBlock* next = block->next;
+      upstream_->deallocate(block, size_t(1) << size_class, kBlockAlignment);
+      block = next;
+    }
+  }
+}
+
+size_t RetainingMemoryResource::SizeClass(size_t bytes) {
+  size_t size_class = kMinSizeClass;
+  while ((size_t(1) << size_class) < bytes)
+    size_class++;
+  return size_class;
+}
+
+// Over-aligned blocks are rare, they are passed to upstream as is
+void* RetainingMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+  if (alignment > kBlockAlignment)
+    return upstream_->allocate(bytes, alignment);
+  const size_t size_class = SizeClass(bytes);
+  FreeBlock* block = free_lists_[size_class];
+  if (!block)
+    return upstream_->allocate(size_t(1) << size_class, kBlockAlignment);
+  free_lists_[size_class] = block->next;
+  return block;
+}
+
+void RetainingMemoryResource::do_deallocate(void* p, size_t bytes,
+                                            size_t alignment) {
+  if (alignment > kBlockAlignment) {
+    upstream_->deallocate(p, bytes, alignment);
+    return;
+  }
+  const size_t size_class = SizeClass(bytes);
+  FreeBlock* block = static_cast<FreeBlock*>(p);
+  block->next = free_lists_[size_class];
+  free_lists_[size_class] = block;
+}
+
+bool RetainingMemoryResource::do_is_equal(
+    const std::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+}  // geom
@@ -0,0 +1,44 @@
+#ifndef RETAINING_MEMORY_RESOURCE_H
+#define RETAINING_MEMORY_RESOURCE_H
+
+#include <cstddef>
+#include <memory_resource>
+
+namespace geom {
+
+// Memory resource that keeps all the memory until it's destroyed
+// Freed blocks are put to free lists by power of two size classes
+// and given out again to the next allocations of the same class,
+// so repeating the same work makes no upstream allocations
+// Not thread-safe
+class RetainingMemoryResource : public std::pmr::memory_resource {
+ public:
+  explicit RetainingMemoryResource(
+      std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+  ~RetainingMemoryResource() override;
+
+  RetainingMemoryResource(const RetainingMemoryResource&) = delete;
+  RetainingMemoryResource& operator=(const RetainingMemoryResource&) = delete;
+
+ private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+
+  static constexpr size_t kMinSizeClass = 4;
+  static constexpr size_t kSizeClasses = 64;
+
+  static size_t SizeClass(size_t bytes);
+
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+  bool do_is_equal(
+      const std::pmr::memory_resource& other) const noexcept override;
+
+  std::pmr::memory_resource* upstream_;
+  FreeBlock* free_lists_[kSizeClasses] = {};
+};
+
+}  // geom
+
+#endif  // RETAINING_MEMORY_RESOURCE_H
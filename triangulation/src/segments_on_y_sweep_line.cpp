@@ -1,47 +1,61 @@
 #include <segments_on_y_sweep_line.h>
 
-#include <cassert>
-
 namespace geom {
 
-double SegmentsOnYSweepLine::y = 0;
-
+// Segments meeting at the sweep line are ordered by direction:
+// on the side the sweep goes next when one of them starts there
+// and on the side the sweep came from otherwise
+// Overlapping segments are ordered by their ends to keep the order strict
 bool SegmentsOnYSweepLine::SegmentOnSweepLineComparator::operator()(
-    const Segment2D& lhs, const Segment2D& rhs) const {
-  if (DoubleEqual(lhs, rhs))
+    const SlopedSegment2D& lhs, const SlopedSegment2D& rhs) const {
+  const Segment2D& l = lhs.segment;
+  const Segment2D& r = rhs.segment;
+  if (l == r)
     return false;
-  const double lhx = AnyXAtSweepLine(lhs), rhx = AnyXAtSweepLine(rhs);
-  if (DoubleEqual(lhx, rhx)) {
-    const bool left = MoreThenPiAngle2D({lhs.a, lhs.b}, {rhs.a, rhs.b});
-    if (DoubleEqual(lhs.a, rhs.a))
-      return left;
-    if (DoubleEqual(lhs.b, rhs.b))
-      return !left;
-    assert(false);
-    return false;
-  }
-  return lhx < rhx;
+  const int x_order = CompareXAtY(lhs, rhs, *y);
+  if (x_order != 0)
+    return x_order < 0;
+  const int turn = CrossProductSign(l.a, l.b, r.a, r.b);
+  if (turn == 0)
+    return l < r;
+  const bool left = turn < 0;
+  if (l.a == r.a)
+    return left;
+  if (l.b == r.b)
+    return !left;
+  if (l.a.y == *y || r.a.y == *y)
+    return left;
+  return !left;
 }
 
-void SegmentsOnYSweepLine::Add(const Segment2D& segment) {
-  segments_on_sweep_line_.insert(segment);
+bool SegmentsOnYSweepLine::SegmentOnSweepLineComparator::operator()(
+    const SlopedSegment2D& lhs, const AtX& rhs) const {
+  return CompareXAtY(lhs, rhs.segment, *y) < 0;
+}
+
+bool SegmentsOnYSweepLine::SegmentOnSweepLineComparator::operator()(
+    const AtX& lhs, const SlopedSegment2D& rhs) const {
+  return CompareXAtY(lhs.segment, rhs, *y) < 0;
+}
+
+SegmentsOnYSweepLine::SegmentsOnYSweepLine(
+    std::pmr::memory_resource* memory) :
+    y_(0),
+    segments_on_sweep_line_(SegmentOnSweepLineComparator{&y_}, memory) {}
+
+void SegmentsOnYSweepLine::Add(const Segment2D& segment, uint32_t tag) {
+  segments_on_sweep_line_.emplace(SlopedSegment2D(segment), tag);
 }
 
 void SegmentsOnYSweepLine::Remove(const Segment2D& segment) {
-  segments_on_sweep_line_.erase(segment);
+  segments_on_sweep_line_.erase(SlopedSegment2D(segment));
 }
 
 std::optional<Segment2D> SegmentsOnYSweepLine::FirstLeft(
     const Segment2D& segment) const {
-  auto left = segments_on_sweep_line_.upper_bound(segment);
-  left = PrevIt(left);
-  while (left != segments_on_sweep_line_.end()) {
-    if (!DoubleEqual(AnyXAtSweepLine(segment), AnyXAtSweepLine(*left)))
-      break;
-    left = PrevIt(left);
-  }
+  const iterator left = FirstLeftIt(segment);
   if (left != segments_on_sweep_line_.end())
-    return *left;
+    return left->first.segment;
   return {};
 }
 
@@ -50,38 +64,55 @@ std::optional<Segment2D> SegmentsOnYSweepLine::FirstLeft(
   return FirstLeft({point, point});
 }
 
+std::optional<uint32_t> SegmentsOnYSweepLine::FirstLeftTag(
+    const Point2D& point) const {
+  const iterator left = FirstLeftIt({point, point});
+  if (left != segments_on_sweep_line_.end())
+    return left->second;
+  return {};
+}
+
+// Segments at the same x are skipped by a single descent
+// however many of them meet there
 std::optional<Segment2D> SegmentsOnYSweepLine::FirstRight(
     const Segment2D& segment) const {
-  auto right = segments_on_sweep_line_.upper_bound(segment);
-  for (; right != segments_on_sweep_line_.end(); right++) {
-    if (!DoubleEqual(AnyXAtSweepLine(segment), AnyXAtSweepLine(*right)))
-      break;
-  }
+  const iterator right =
+      segments_on_sweep_line_.upper_bound(AtX{SlopedSegment2D(segment)});
   if (right != segments_on_sweep_line_.end())
-    return *right;
+    return right->first.segment;
   return {};
 }
 
-void SegmentsOnYSweepLine::SetY(double y) {
-  SegmentsOnYSweepLine::y = y;
+std::optional<Segment2D> SegmentsOnYSweepLine::Prev(
+    const Segment2D& segment) const {
+  const iterator it =
+      segments_on_sweep_line_.find(SlopedSegment2D(segment));
+  if (it == segments_on_sweep_line_.end() ||
+      it == segments_on_sweep_line_.begin())
+    return {};
+  return std::prev(it)->first.segment;
 }
 
-SegmentsOnYSweepLine::iterator SegmentsOnYSweepLine::PrevIt(
-    SegmentsOnYSweepLine::iterator it) const {
-  if (it == segments_on_sweep_line_.begin())
-    return segments_on_sweep_line_.end();
-  if (segments_on_sweep_line_.size() == 0)
-    return segments_on_sweep_line_.end();
-  return std::prev(it);
+std::optional<Segment2D> SegmentsOnYSweepLine::Next(
+    const Segment2D& segment) const {
+  iterator it = segments_on_sweep_line_.find(SlopedSegment2D(segment));
+  if (it == segments_on_sweep_line_.end() ||
+      ++it == segments_on_sweep_line_.end())
+    return {};
+  return it->first.segment;
+}
+
+void SegmentsOnYSweepLine::SetY(double y) {
+  y_ = y;
 }
 
-double SegmentsOnYSweepLine::AnyXAtSweepLine(
-    const Segment2D& segment) {
-  const Vector2D v = {segment.a, segment.b};
-  if (v.y == 0)
-    return segment.a.x;
-  double k = (y - segment.a.y) / (v.y);
-  return segment.a.x + v.x * k;
+SegmentsOnYSweepLine::iterator SegmentsOnYSweepLine::FirstLeftIt(
+    const Segment2D& segment) const {
+  const iterator left =
+      segments_on_sweep_line_.lower_bound(AtX{SlopedSegment2D(segment)});
+  if (left == segments_on_sweep_line_.begin())
+    return segments_on_sweep_line_.end();
+  return std::prev(left);
 }
 
 }  // geom
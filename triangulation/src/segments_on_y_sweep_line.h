@@ -3,35 +3,65 @@
 
 #include <geom_utils.h>
 
+#include <cstdint>
+#include <map>
+#include <memory_resource>
 #include <optional>
-#include <set>
 
 namespace geom {
 
+// Every instance keeps its own sweep line position,
+// so independent sweeps may run concurrently
+// Segments may carry a tag (e.g. index of the polygon edge)
+// returned by the lookups, so callers don't need a map of segments
 class SegmentsOnYSweepLine {
  public:
-  void Add(const Segment2D& segment);
+  explicit SegmentsOnYSweepLine(std::pmr::memory_resource* memory =
+                                    std::pmr::get_default_resource());
+
+  SegmentsOnYSweepLine(const SegmentsOnYSweepLine&) = delete;
+  SegmentsOnYSweepLine& operator=(const SegmentsOnYSweepLine&) = delete;
+
+  void Add(const Segment2D& segment, uint32_t tag = 0);
   void Remove(const Segment2D& segment);
 
   std::optional<Segment2D> FirstLeft(const Segment2D& segment) const;
   std::optional<Segment2D> FirstLeft(const Point2D& point) const;
   std::optional<Segment2D> FirstRight(const Segment2D& segment) const;
+  // Tag of FirstLeft(point)
+  std::optional<uint32_t> FirstLeftTag(const Point2D& point) const;
+  // Neighbours of a segment on the sweep line in the strict order,
+  // unlike FirstLeft and FirstRight segments meeting it aren't skipped
+  std::optional<Segment2D> Prev(const Segment2D& segment) const;
+  std::optional<Segment2D> Next(const Segment2D& segment) const;
 
-  static void SetY(double y);
+  void SetY(double y);
 
  private:
-  struct SegmentOnSweepLineComparator {
-    bool operator()(const Segment2D& lhs, const Segment2D& rhs) const;
+  // Lookup key ordered by x at the sweep line only,
+  // equal to every segment through the same point
+  struct AtX {
+    SlopedSegment2D segment;
   };
 
-  static double y;
+  struct SegmentOnSweepLineComparator {
+    using is_transparent = void;
+
+    const double* y;
 
-  static double AnyXAtSweepLine(const Segment2D& segment);
+    bool operator()(const SlopedSegment2D& lhs,
+                    const SlopedSegment2D& rhs) const;
+    bool operator()(const SlopedSegment2D& lhs, const AtX& rhs) const;
+    bool operator()(const AtX& lhs, const SlopedSegment2D& rhs) const;
+  };
 
-  using iterator = std::set<Segment2D, SegmentOnSweepLineComparator>::iterator;
-  iterator PrevIt(iterator it) const;
+  using SegmentsMap = std::pmr::map<SlopedSegment2D, uint32_t,
+                                    SegmentOnSweepLineComparator>;
+  using iterator = SegmentsMap::const_iterator;
+  iterator FirstLeftIt(const Segment2D& segment) const;
 
-  std::set<Segment2D, SegmentOnSweepLineComparator> segments_on_sweep_line_;
+  double y_;
+  SegmentsMap segments_on_sweep_line_;
 };
 
 }  // geom
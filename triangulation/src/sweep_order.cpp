@@ -0,0 +1,101 @@
+#include <sweep_order.h>
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <numeric>
+
+namespace geom {
+
+namespace {
+
+// Below it radix passes cost more than comparisons
+constexpr size_t kMinRadixSortSize = 512;
+
+constexpr int kDigitBits = 11;
+constexpr uint64_t kBuckets = uint64_t(1) << kDigitBits;
+constexpr int kKeyDigits = (64 + kDigitBits - 1) / kDigitBits;
+
+// Unsigned integers in the order of the doubles, -0 is the same as 0
+uint64_t OrderedBits(double value) {
+  value += 0.0;
+  uint64_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  const uint64_t sign = uint64_t(1) << 63;
+  return bits & sign ? ~bits : bits | sign;
+}
+
+// Ascending order of keys is the descending order of y
+struct SweepKey {
+  uint64_t key;
+  uint32_t vertex;
+};
+
+// Stable counting sort by one digit of the keys
+// Returns false without sorting if all keys have the same digit
+bool SortByDigit(const std::pmr::vector<SweepKey>& from,
+                 std::pmr::vector<SweepKey>* to, int shift,
+                 std::array<uint32_t, kBuckets>* counts) {
+  if ((*counts)[(from.front().key >> shift) & (kBuckets - 1)] == from.size())
+    return false;
+  std::exclusive_scan(counts->begin(), counts->end(), counts->begin(), 0u);
+  for (const SweepKey& sweep_key : from)
+    (*to)[(*counts)[(sweep_key.key >> shift) & (kBuckets - 1)]++] = sweep_key;
+  return true;
+}
+
+// Vertices are radix sorted by y only,
+// vertices of the same y are ordered by the comparator then
+std::pmr::vector<uint32_t> RadixSweepOrder(
+    const double* x, const double* y, const Polygon2D::VertexType* types,
+    uint32_t size, std::pmr::memory_resource* memory) {
+  std::pmr::vector<SweepKey> keys(size, memory);
+  std::pmr::vector<SweepKey> buffer(size, memory);
+  // Histograms of every digit are counted in one pass
+  std::pmr::vector<std::array<uint32_t, kBuckets> > counts(kKeyDigits,
+                                                           memory);
+  for (uint32_t i = 0; i < size; i++) {
+    keys[i] = {~OrderedBits(y[i]), i};
+    for (int digit = 0; digit < kKeyDigits; digit++)
+      counts[digit][(keys[i].key >> (digit * kDigitBits)) & (kBuckets - 1)]++;
+  }
+  for (int digit = 0; digit < kKeyDigits; digit++)
+    if (SortByDigit(keys, &buffer, digit * kDigitBits, &counts[digit]))
+      keys.swap(buffer);
+
+  std::pmr::vector<uint32_t> order(size, memory);
+  for (uint32_t i = 0; i < size; i++)
+    order[i] = keys[i].vertex;
+  const YFirstVertexComparator less(x, y, types);
+  for (uint32_t begin = 0, end = 1; begin < size; begin = end++) {
+    while (end < size && keys[end].key == keys[begin].key)
+      end++;
+    if (end - begin > 1)
+      std::sort(order.rbegin() + (size - end), order.rbegin() + (size - begin),
+                less);
+  }
+  return order;
+}
+
+}  // namespace
+
+std::pmr::vector<uint32_t> SweepOrder(
+    const double* x, const double* y, const Polygon2D::VertexType* types,
+    size_t size, std::pmr::memory_resource* memory) {
+  if (size >= kMinRadixSortSize)
+    return RadixSweepOrder(x, y, types, static_cast<uint32_t>(size), memory);
+
+  std::pmr::vector<uint32_t> order(size, memory);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.rbegin(), order.rend(),
+            YFirstVertexComparator(x, y, types));
+  return order;
+}
+
+std::pmr::vector<uint32_t> SweepOrder(const Polygon2D& polygon,
+                                      std::pmr::memory_resource* memory) {
+  return SweepOrder(polygon.X(), polygon.Y(), polygon.Types(),
+                    polygon.Size(), memory);
+}
+
+}  // geom
@@ -0,0 +1,29 @@
+#ifndef SWEEP_ORDER_H
+#define SWEEP_ORDER_H
+
+#include <polygon2d.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <vector>
+
+namespace geom {
+
+// Vertex indices from the highest vertex to the lowest one,
+// the reversed order of YFirstVertexComparator on the same arrays
+// Large inputs are sorted by LSD radix sort of y mapped
+// to order-preserving integers, vertices of the same y by std::sort,
+// small inputs are sorted by std::sort only
+std::pmr::vector<uint32_t> SweepOrder(
+    const double* x, const double* y, const Polygon2D::VertexType* types,
+    size_t size,
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+std::pmr::vector<uint32_t> SweepOrder(
+    const Polygon2D& polygon,
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+}  // geom
+
+#endif  // SWEEP_ORDER_H
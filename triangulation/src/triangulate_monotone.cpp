@@ -1,76 +1,137 @@
 #include <triangulate_monotone.h>
 
-#include <dcel_polygon2d.h>
 #include <geom_utils.h>
+#include <sweep_order.h>
 
-#include <algorithm>
-#include <stack>
+#include <cstdint>
 #include <vector>
 
 namespace geom {
 
 namespace {
 
-bool IsAdjacent(const Polygon2D::Vertex* a, const Polygon2D::Vertex* b) {
-  return a->prev == b || a->next == b;
+bool IsAdjacent(const Polygon2D& polygon, uint32_t a, uint32_t b) {
+  return polygon.Prev(a) == b || polygon.Next(a) == b;
 }
 
-bool IsValidDiagonal(const Polygon2D::Vertex* current,
-                     const Polygon2D::Vertex* last,
-                     const Polygon2D::Vertex* to_process) {
-  Vector2D v = {current->point, last->point};
-  Vector2D u = {current->point, to_process->point};
-  bool right = MoreThenPiAngle2D(u, v);
-  return (current->type == Polygon2D::RIGHT_REGULAR) == right;
+// Diagonal collinear with the chain would overlap its edges,
+// so the turn has to be strict
+bool IsValidDiagonal(const Polygon2D& polygon, uint32_t current,
+                     uint32_t last, uint32_t to_process) {
+  const int turn = Orient2D(polygon.Point(current), polygon.Point(to_process),
+                            polygon.Point(last));
+  if (polygon.Type(current) == Polygon2D::RIGHT_REGULAR)
+    return turn < 0;
+  return turn > 0;
+}
+
+// Chains going down from the top vertex are merged as sorted lists,
+// the sweep order is sorted from scratch only if a chain goes up
+// (it's not y-monotone then)
+std::pmr::vector<uint32_t> MonotoneSweepOrder(
+    const Polygon2D& polygon, std::pmr::memory_resource* memory) {
+  const YFirstVertexComparator less(polygon);
+  const uint32_t size = static_cast<uint32_t>(polygon.Size());
+  uint32_t top = 0;
+  for (uint32_t i = 1; i < size; i++)
+    if (less(top, i))
+      top = i;
+
+  std::pmr::vector<uint32_t> order(memory);
+  order.reserve(size);
+  order.push_back(top);
+  uint32_t right = polygon.Next(top);
+  uint32_t left = polygon.Prev(top);
+  while (right != left) {
+    if (less(left, right)) {
+      order.push_back(right);
+      const uint32_t next = polygon.Next(right);
+      if (less(right, next))
+        return SweepOrder(polygon, memory);
+      right = next;
+    } else {
+      order.push_back(left);
+      const uint32_t prev = polygon.Prev(left);
+      if (less(left, prev))
+        return SweepOrder(polygon, memory);
+      left = prev;
+    }
+  }
+  order.push_back(right);
+  return order;
 }
 
 }  // namespace
 
-// Moving with y sweep line insering edges as long as we can
-std::list<Polygon2D> TriangulateYMonotone(const Polygon2D& polygon) {
-  if (polygon.Size() < 4)
-    return {polygon};
+// Moving with y sweep line cutting off triangles as long as we can
+// Ring is clockwise, so its right chain goes down along next
+// and every triangle is written clockwise
+std::pmr::vector<VertexTriangle> TriangulateYMonotone(
+    const Polygon2D& polygon,
+    std::pmr::memory_resource* memory,
+    TriangulationStats* stats) {
+  std::pmr::vector<VertexTriangle> triangles(memory);
+  if (polygon.Size() < 3)
+    return triangles;
+  triangles.reserve(polygon.Size() - 2);
+  if (polygon.Size() == 3) {
+    triangles.push_back({0, 1, 2});
+    return triangles;
+  }
+
+  // Triangle of the current vertex and two consecutive stack vertices,
+  // lower is the one pushed later
+  auto AddTriangle = [&](uint32_t current, uint32_t lower, uint32_t upper,
+                         bool current_on_right) {
+    if (current_on_right)
+      triangles.push_back({current, lower, upper});
+    else
+      triangles.push_back({current, upper, lower});
+  };
 
-  DcelPolygon2D dcel_polygon(polygon);
-  std::vector<const Polygon2D::Vertex*> vertices = AsVertexVector(polygon);
-  std::sort(vertices.rbegin(), vertices.rend(), YFirstVertexComparator());
-  std::stack<const Polygon2D::Vertex*> to_process_stk;
-  to_process_stk.push(vertices[0]);
-  to_process_stk.push(vertices[1]);
+  const std::pmr::vector<uint32_t> vertices =
+      MonotoneSweepOrder(polygon, memory);
+  std::pmr::vector<uint32_t> to_process_stk(memory);
+  to_process_stk.reserve(vertices.size());
+  to_process_stk.push_back(vertices[0]);
+  to_process_stk.push_back(vertices[1]);
   size_t i = 2;
   for (; i < vertices.size() - 1; i++) {
-    if (IsAdjacent(vertices[i], to_process_stk.top())) {
-      const Polygon2D::Vertex* last = to_process_stk.top();
-      to_process_stk.pop();
+    const uint32_t current = vertices[i];
+    const bool on_right = polygon.Type(current) == Polygon2D::RIGHT_REGULAR;
+    if (IsAdjacent(polygon, current, to_process_stk.back())) {
+      // Same chain, stack vertices above the current one
+      // are cut off while the diagonals are inside
+      uint32_t last = to_process_stk.back();
+      to_process_stk.pop_back();
       while (to_process_stk.size() > 0 &&
-          IsValidDiagonal(vertices[i], last, to_process_stk.top())) {
-        last = to_process_stk.top();
-        to_process_stk.pop();
-        dcel_polygon.InsertEdge({vertices[i]->point, last->point});
+          IsValidDiagonal(polygon, current, last, to_process_stk.back())) {
+        AddTriangle(current, last, to_process_stk.back(), !on_right);
+        last = to_process_stk.back();
+        to_process_stk.pop_back();
       }
-      to_process_stk.push(last);
-      to_process_stk.push(vertices[i]);
+      to_process_stk.push_back(last);
+      to_process_stk.push_back(current);
     } else {
-      while (to_process_stk.size() > 0) {
-        if (to_process_stk.size() != 1) {
-          dcel_polygon.InsertEdge(
-              {vertices[i]->point, to_process_stk.top()->point});
-        }
-        to_process_stk.pop();
-      }
-      to_process_stk.push(vertices[i - 1]);
-      to_process_stk.push(vertices[i]);
-    }
-  }
-  to_process_stk.pop();
-  while (to_process_stk.size() > 0) {
-    if (to_process_stk.size() != 1) {
-      dcel_polygon.InsertEdge(
-          {vertices[i]->point, to_process_stk.top()->point});
+      // Opposite chain, the whole stack is fanned from the current vertex
+      for (size_t j = to_process_stk.size() - 1; j > 0; j--)
+        AddTriangle(current, to_process_stk[j], to_process_stk[j - 1],
+                    on_right);
+      to_process_stk.clear();
+      to_process_stk.push_back(vertices[i - 1]);
+      to_process_stk.push_back(current);
     }
-    to_process_stk.pop();
   }
-  return dcel_polygon.GetPolygons();
+  // The lowest vertex closes the fan of the rest of the stack,
+  // it's on the chain opposite to the stack one
+  const bool on_right =
+      polygon.Type(to_process_stk.back()) == Polygon2D::LEFT_REGULAR;
+  for (size_t j = to_process_stk.size() - 1; j > 0; j--)
+    AddTriangle(vertices[i], to_process_stk[j], to_process_stk[j - 1],
+                on_right);
+  if (stats)
+    stats->inserted_edges += triangles.size() - 1;
+  return triangles;
 }
 
 }  // geom
@@ -2,12 +2,22 @@
 #define TRIANGULATE_MONOTONE_H
 
 #include <polygon2d.h>
+#include <triangulation_base_geometry.h>
+#include <triangulation_stats.h>
 
-#include <list>
+#include <memory_resource>
+#include <vector>
 
 namespace geom {
 
-std::list<Polygon2D> TriangulateYMonotone(const Polygon2D& polygon);
+// Triangles are clockwise and made straight by the stack algorithm,
+// Size() - 2 of them for a y-monotone polygon of 3 and more vertices
+// Vertices of the triangles are the ones of the polygon, so their ids
+// are at hand (see Polygon2D::Triangle for the points)
+std::pmr::vector<VertexTriangle> TriangulateYMonotone(
+    const Polygon2D& polygon,
+    std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+    TriangulationStats* stats = nullptr);
 
 }  // geom
 
@@ -1,34 +1,508 @@
 #include <triangulation.h>
 
+#include <buffered_file_writer.h>
 #include <decompose_to_monotones.h>
+#include <ear_clipping.h>
+#include <geom_utils.h>
+#include <parallel_for.h>
 #include <polygon2d.h>
+#include <polygon_shape.h>
 #include <resolve_intersections.h>
+#include <retaining_memory_resource.h>
 #include <triangulate_monotone.h>
+#include <triangulation_mapped_file.h>
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <memory_resource>
 #include <optional>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace geom {
 
 namespace {
 
-std::optional<Triangle2D> AsTriangle(const Polygon2D& polygon) {
-  if (polygon.Size() != 3) {
-    assert(false);
-    return {};
+// Adds its lifetime to the given time of stats
+// Clock isn't read at all without stats
+class StageTimer {
+ public:
+  StageTimer(TriangulationStats* stats,
+             std::chrono::nanoseconds TriangulationStats::* time) :
+      time_(stats ? &(stats->*time) : nullptr),
+      start_(time_ ? std::chrono::steady_clock::now()
+                   : std::chrono::steady_clock::time_point()) {}
+
+  ~StageTimer() {
+    if (time_)
+      *time_ += std::chrono::steady_clock::now() - start_;
+  }
+
+ private:
+  std::chrono::nanoseconds* time_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+// Times aren't added since stages of pieces overlap in parallel mode
+void AddCounters(const TriangulationStats& from, TriangulationStats* to) {
+  to->intersections += from.intersections;
+  to->events += from.events;
+  to->inserted_edges += from.inserted_edges;
+  to->monotone_pieces += from.monotone_pieces;
+  to->ear_clipped_pieces += from.ear_clipped_pieces;
+  to->triangles += from.triangles;
+}
+
+template<class T>
+Polygon2D MakePolygon(const BasicPoint2D<T>* first,
+                      const BasicPoint2D<T>* last,
+                      TriangulationOptions::Orientation orientation,
+                      std::pmr::memory_resource* memory) {
+  switch (orientation) {
+    case TriangulationOptions::CLOCKWISE:
+      return Polygon2D::FromClockwiseRing(first, last, memory);
+    case TriangulationOptions::COUNTERCLOCKWISE:
+      return Polygon2D::FromCounterclockwiseRing(first, last, memory);
+    default:
+      return Polygon2D::FromRing(first, last, memory);
+  }
+}
+
+// Stages below consume triangles as vertices of the piece they're made of,
+// so the ids of the vertices are at hand for the indexed output
+// Consumers of points are wrapped into this
+template<class PointsConsumer>
+auto ConsumePoints(PointsConsumer consume) {
+  return [consume](const Polygon2D& piece,
+                   const VertexTriangle& triangle) mutable {
+    consume(piece.Triangle(triangle));
+  };
+}
+
+// Every triangle shares the same vertex
+// Triangles are clockwise as the ones made by the pipeline
+template<class TriangleConsumer>
+void ConsumeFanTriangles(const Polygon2D& convex_polygon,
+                         TriangulationStats* stats,
+                         TriangleConsumer consume) {
+  if (convex_polygon.Size() < 3)
+    return;
+  for (uint32_t i = 1; i + 1 < convex_polygon.Size(); i++) {
+    if (stats)
+      stats->triangles++;
+    consume(convex_polygon, VertexTriangle{0, i, i + 1});
+  }
+}
+
+std::pmr::list<Polygon2D> DecomposeToYMonotonesTimed(
+    const Polygon2D& polygon,
+    std::pmr::memory_resource* memory,
+    TriangulationStats* stats) {
+  StageTimer timer(stats, &TriangulationStats::decompose_time);
+  std::pmr::list<Polygon2D> y_monotones =
+      DecomposeToYMonotones(polygon, memory, stats);
+  if (stats)
+    stats->monotone_pieces += y_monotones.size();
+  return y_monotones;
+}
+
+template<class TriangleConsumer>
+void ConsumeYMonotoneTriangles(const Polygon2D& y_monotone,
+                               std::pmr::memory_resource* memory,
+                               TriangulationStats* stats,
+                               TriangleConsumer consume) {
+  std::pmr::vector<VertexTriangle> triangles(memory);
+  {
+    StageTimer timer(stats, &TriangulationStats::triangulate_monotone_time);
+    triangles = TriangulateYMonotone(y_monotone, memory, stats);
+  }
+  if (stats)
+    stats->triangles += triangles.size();
+  for (const VertexTriangle& triangle : triangles)
+    consume(y_monotone, triangle);
+}
+
+// y-monotones are triangulated as soon as the decomposition builds them,
+// so they aren't kept all at once
+// Time spent on them isn't added to decompose_time
+template<class TriangleConsumer>
+void ConsumeDecomposedTriangles(const Polygon2D& simple_polygon,
+                                std::pmr::memory_resource* memory,
+                                TriangulationStats* stats,
+                                TriangleConsumer consume) {
+  std::chrono::nanoseconds y_monotones_time(0);
+  {
+    StageTimer timer(stats, &TriangulationStats::decompose_time);
+    DecomposeToYMonotones(simple_polygon, [&](Polygon2D&& y_monotone) {
+      if (!stats) {
+        ConsumeYMonotoneTriangles(y_monotone, memory, stats, consume);
+        return;
+      }
+      const auto start = std::chrono::steady_clock::now();
+      stats->monotone_pieces++;
+      ConsumeYMonotoneTriangles(y_monotone, memory, stats, consume);
+      y_monotones_time += std::chrono::steady_clock::now() - start;
+    }, memory, stats);
+  }
+  if (stats)
+    stats->decompose_time -= y_monotones_time;
+}
+
+// Simple polygon skips the checks for self-intersections in both engines
+bool UseEarClipping(const TriangulationOptions& options, size_t size,
+                    bool simple) {
+  switch (options.engine) {
+    case TriangulationOptions::MONOTONE_ENGINE:
+      return false;
+    case TriangulationOptions::EAR_CLIPPING_ENGINE:
+      return true;
+    default:
+      return size < (simple ? options.simple_ear_clipping_threshold
+                            : options.ear_clipping_threshold);
+  }
+}
+
+// Nothing is consumed if ear clipping fails on the polygon
+template<class TriangleConsumer>
+bool ConsumeEarClippingTriangles(const Polygon2D& simple_polygon,
+                                 std::pmr::memory_resource* memory,
+                                 TriangulationStats* stats,
+                                 TriangleConsumer consume) {
+  std::optional<std::pmr::vector<VertexTriangle> > triangles;
+  {
+    StageTimer timer(stats, &TriangulationStats::ear_clipping_time);
+    triangles = TriangulateByEarClipping(simple_polygon, memory);
+  }
+  if (!triangles)
+    return false;
+  if (stats) {
+    stats->ear_clipped_pieces++;
+    stats->triangles += triangles->size();
+  }
+  for (const VertexTriangle& triangle : *triangles)
+    consume(simple_polygon, triangle);
+  return true;
+}
+
+// Simple polygons and y-monotone pieces are independent
+// so each stage is run over all of them with ParallelFor
+// Results are collected by piece index and consumed at the end,
+// so the order is the same as in the sequential version
+// Workers allocate from the default memory resource
+// since the one of the context isn't thread-safe
+// and count into stats of their piece, merged after each stage
+template<class TriangleConsumer>
+void TriangulatePiecesParallel(
+    const std::pmr::list<Polygon2D>& simple_polygons,
+    const TriangulationOptions& options,
+    TriangulationStats* stats,
+    TriangleConsumer consume) {
+  const size_t num_threads = options.num_threads;
+  const std::vector<const Polygon2D*> simple_polygon_ptrs = [&]() {
+    std::vector<const Polygon2D*> ptrs;
+    for (const Polygon2D& simple_polygon : simple_polygons)
+      ptrs.push_back(&simple_polygon);
+    return ptrs;
+  }();
+  std::vector<TriangulationStats> piece_stats;
+  auto PieceStats = [&](size_t i) {
+    return stats ? &piece_stats[i] : nullptr;
+  };
+  auto MergePieceStats = [&]() {
+    for (const TriangulationStats& stats_of_piece : piece_stats)
+      AddCounters(stats_of_piece, stats);
+  };
+
+  // Small pieces are ear clipped in a stage of their own,
+  // y-monotone simple polygons of the rest are used as is
+  std::vector<char> ear_clipped(simple_polygon_ptrs.size(), false);
+  std::vector<std::vector<VertexTriangle> > ear_triangles(
+      simple_polygon_ptrs.size());
+  std::vector<char> decomposed(simple_polygon_ptrs.size(), false);
+  std::vector<std::pmr::list<Polygon2D> > y_monotones(
+      simple_polygon_ptrs.size());
+  if (stats)
+    piece_stats.assign(simple_polygon_ptrs.size(), TriangulationStats());
+  {
+    StageTimer timer(stats, &TriangulationStats::ear_clipping_time);
+    ParallelFor(simple_polygon_ptrs.size(), num_threads, [&](size_t i) {
+      if (UseEarClipping(options, simple_polygon_ptrs[i]->Size(), true))
+        ear_clipped[i] = ConsumeEarClippingTriangles(
+            *simple_polygon_ptrs[i], std::pmr::get_default_resource(),
+            PieceStats(i),
+            [&](const Polygon2D&, const VertexTriangle& triangle) {
+          ear_triangles[i].push_back(triangle);
+        });
+    });
+  }
+  MergePieceStats();
+
+  if (stats)
+    piece_stats.assign(simple_polygon_ptrs.size(), TriangulationStats());
+  {
+    StageTimer timer(stats, &TriangulationStats::decompose_time);
+    ParallelFor(simple_polygon_ptrs.size(), num_threads, [&](size_t i) {
+      if (ear_clipped[i])
+        return;
+      if (IsSimpleYMonotone(*simple_polygon_ptrs[i])) {
+        if (stats)
+          piece_stats[i].monotone_pieces++;
+        return;
+      }
+      decomposed[i] = true;
+      y_monotones[i] = DecomposeToYMonotonesTimed(
+          *simple_polygon_ptrs[i], std::pmr::get_default_resource(),
+          PieceStats(i));
+    });
+  }
+  MergePieceStats();
+
+  std::vector<const Polygon2D*> y_monotone_ptrs;
+  // y-monotones of the i-th simple polygon end at y_monotones_end[i]
+  std::vector<size_t> y_monotones_end(simple_polygon_ptrs.size());
+  for (size_t i = 0; i < simple_polygon_ptrs.size(); i++) {
+    if (decomposed[i]) {
+      for (const Polygon2D& y_monotone : y_monotones[i])
+        y_monotone_ptrs.push_back(&y_monotone);
+    } else if (!ear_clipped[i]) {
+      y_monotone_ptrs.push_back(simple_polygon_ptrs[i]);
+    }
+    y_monotones_end[i] = y_monotone_ptrs.size();
+  }
+  std::vector<std::vector<VertexTriangle> > triangles(
+      y_monotone_ptrs.size());
+  if (stats)
+    piece_stats.assign(y_monotone_ptrs.size(), TriangulationStats());
+  {
+    StageTimer timer(stats, &TriangulationStats::triangulate_monotone_time);
+    ParallelFor(y_monotone_ptrs.size(), num_threads, [&](size_t i) {
+      ConsumeYMonotoneTriangles(*y_monotone_ptrs[i],
+                                std::pmr::get_default_resource(),
+                                PieceStats(i),
+                                [&](const Polygon2D&,
+                                    const VertexTriangle& triangle) {
+        triangles[i].push_back(triangle);
+      });
+    });
+  }
+  MergePieceStats();
+
+  size_t y_monotone = 0;
+  for (size_t i = 0; i < simple_polygon_ptrs.size(); i++) {
+    for (const VertexTriangle& triangle : ear_triangles[i])
+      consume(*simple_polygon_ptrs[i], triangle);
+    for (; y_monotone < y_monotones_end[i]; y_monotone++) {
+      for (const VertexTriangle& triangle : triangles[y_monotone])
+        consume(*y_monotone_ptrs[y_monotone], triangle);
+    }
+  }
+}
+
+// Simple polygons are ear clipped or decomposed to y-monotones
+// according to the engine of options
+template<class TriangleConsumer>
+void ConsumeSimplePolygonsTriangles(
+    const std::pmr::list<Polygon2D>& simple_polygons,
+    const TriangulationOptions& options,
+    std::pmr::memory_resource* memory,
+    TriangulationStats* stats,
+    TriangleConsumer consume) {
+  if (options.num_threads != 1) {
+    TriangulatePiecesParallel(simple_polygons, options, stats, consume);
+    return;
+  }
+
+  for (const Polygon2D& simple_polygon : simple_polygons) {
+    if (UseEarClipping(options, simple_polygon.Size(), true) &&
+        ConsumeEarClippingTriangles(simple_polygon, memory, stats, consume))
+      continue;
+    if (IsSimpleYMonotone(simple_polygon)) {
+      if (stats)
+        stats->monotone_pieces++;
+      ConsumeYMonotoneTriangles(simple_polygon, memory, stats, consume);
+      continue;
+    }
+    ConsumeDecomposedTriangles(simple_polygon, memory, stats, consume);
+  }
+}
+
+// Input isn't needed after the polygon is made of it
+template<class T, class TriangleConsumer>
+void TriangulateImpl(const BasicPoint2D<T>* first,
+                     const BasicPoint2D<T>* last,
+                     const TriangulationOptions& options,
+                     TriangleConsumer consume) {
+  std::pmr::memory_resource* memory = options.context ?
+      options.context->memory_resource() : std::pmr::get_default_resource();
+  TriangulationStats* stats = options.stats;
+  Polygon2D polygon =
+      MakePolygon(first, last, options.known_orientation, memory);
+
+  // Fast paths skip the stages which wouldn't change anything
+  const PolygonShape shape = options.known_convex ?
+      CONVEX : ClassifyPolygon(polygon, options.known_simple);
+  if (shape == CONVEX) {
+    ConsumeFanTriangles(polygon, stats, consume);
+    return;
+  }
+  // Small simple polygon doesn't need the sweep at all
+  if (UseEarClipping(options, polygon.Size(), options.known_simple) &&
+      (options.known_simple || shape == SIMPLE_Y_MONOTONE ||
+       IsSimpleBruteForce(polygon)) &&
+      ConsumeEarClippingTriangles(polygon, memory, stats, consume))
+    return;
+  if (shape == SIMPLE_Y_MONOTONE) {
+    if (stats)
+      stats->monotone_pieces++;
+    ConsumeYMonotoneTriangles(polygon, memory, stats, consume);
+    return;
+  }
+
+  std::pmr::list<Polygon2D> simple_polygons(memory);
+  if (options.known_simple) {
+    simple_polygons.push_back(std::move(polygon));
+  } else {
+    StageTimer timer(stats, &TriangulationStats::resolve_intersections_time);
+    simple_polygons = ResolveIntersections(polygon, memory, stats);
+  }
+  ConsumeSimplePolygonsTriangles(simple_polygons, options, memory, stats,
+                                 consume);
+}
+
+// Rings of degenerate holes (less than 3 distinct vertices) are skipped
+// Vertex ids of holes follow the ones of the polygon in the order of holes_v
+template<class T, class TriangleConsumer>
+void TriangulateWithHolesImpl(
+    const std::vector<BasicPoint2D<T> >& polygon_v,
+    const std::vector<std::vector<BasicPoint2D<T> > >& holes_v,
+    const TriangulationOptions& options,
+    TriangleConsumer consume) {
+  std::pmr::memory_resource* memory = options.context ?
+      options.context->memory_resource() : std::pmr::get_default_resource();
+  TriangulationStats* stats = options.stats;
+  std::pmr::vector<Polygon2D> holes(memory);
+  holes.reserve(holes_v.size());
+  uint32_t first_id = static_cast<uint32_t>(polygon_v.size());
+  for (const std::vector<BasicPoint2D<T> >& hole_v : holes_v) {
+    Polygon2D hole = Polygon2D::HoleFromRing(
+        hole_v.data(), hole_v.data() + hole_v.size(), memory, first_id);
+    first_id += static_cast<uint32_t>(hole_v.size());
+    if (hole.Size() >= 3)
+      holes.push_back(std::move(hole));
+  }
+  if (holes.empty()) {
+    TriangulateImpl(polygon_v.data(), polygon_v.data() + polygon_v.size(),
+                    options, consume);
+    return;
+  }
+
+  const Polygon2D polygon = Polygon2D::FromRing(
+      polygon_v.data(), polygon_v.data() + polygon_v.size(), memory);
+  std::pmr::list<Polygon2D> y_monotones(memory);
+  {
+    StageTimer timer(stats, &TriangulationStats::decompose_time);
+    y_monotones = DecomposeToYMonotones(polygon, holes, memory, stats);
   }
-  Triangle2D res;
-  const Polygon2D::Vertex* vertex = polygon.GetAnyVertex();
-  res.a = vertex->point;
-  vertex = vertex->next;
-  res.b = vertex->point;
-  vertex = vertex->next;
-  res.c = vertex->point;
-  return res;
+  ConsumeSimplePolygonsTriangles(y_monotones, options, memory, stats,
+                                 consume);
+}
+
+// Times are added too, as totals of the threads of a batch
+void AddStats(const TriangulationStats& from, TriangulationStats* to) {
+  to->resolve_intersections_time += from.resolve_intersections_time;
+  to->decompose_time += from.decompose_time;
+  to->triangulate_monotone_time += from.triangulate_monotone_time;
+  to->ear_clipping_time += from.ear_clipping_time;
+  AddCounters(from, to);
+}
+
+// Calls triangulate(i, polygon_options) for every polygon of a batch
+// on options.num_threads threads, polygon_options are the options
+// with a context and stats of the thread and pieces left sequential
+template<class Triangulator>
+void ForEachOfBatch(size_t size, const TriangulationOptions& options,
+                    Triangulator triangulate) {
+  const size_t num_threads = std::min(
+      size, options.num_threads ? options.num_threads
+                                : DefaultThreadsCount());
+  std::vector<TriangulationContext> contexts(num_threads);
+  std::vector<TriangulationStats> thread_stats(num_threads);
+  ParallelFor(size, num_threads, [&](size_t i, size_t thread) {
+    TriangulationOptions polygon_options = options;
+    polygon_options.num_threads = 1;
+    polygon_options.context = &contexts[thread];
+    polygon_options.stats = options.stats ? &thread_stats[thread] : nullptr;
+    triangulate(i, polygon_options);
+  });
+  if (options.stats) {
+    for (const TriangulationStats& stats_of_thread : thread_stats)
+      AddStats(stats_of_thread, options.stats);
+  }
+}
+
+std::string ToString(const Point2D& point) {
+  std::ostringstream stream;
+  stream.precision(std::numeric_limits<double>::max_digits10);
+  stream << '(' << point.x << ", " << point.y << ')';
+  return stream.str();
+}
+
+// Vertices of pieces carry the index of their input point as the id,
+// so it's the output index as is
+// Points of resolved self-intersections are appended
+// the first time they're used
+// result->points has to be filled with the input points already
+template<class T, class Triangulator>
+void TriangulateIndexed(const TriangulationOptions& options,
+                        BasicIndexedTriangles2D<T>* result,
+                        Triangulator triangulate) {
+  constexpr uint32_t kNoIndex = std::numeric_limits<uint32_t>::max();
+  // Output indices of added vertices by their number
+  std::pmr::vector<uint32_t> added_indices(
+      options.context ? options.context->memory_resource()
+                      : std::pmr::get_default_resource());
+
+  auto IndexOf = [&](const Polygon2D& piece, uint32_t vertex) {
+    const uint32_t id = piece.Id(vertex);
+    if (!(id & kAddedVertexId))
+      return id;
+    const uint32_t added = id & ~kAddedVertexId;
+    if (added >= added_indices.size())
+      added_indices.resize(added + 1, kNoIndex);
+    if (added_indices[added] == kNoIndex) {
+      added_indices[added] = static_cast<uint32_t>(result->points.size());
+      result->points.push_back(FromPoint2D<T>(piece.Point(vertex)));
+    }
+    return added_indices[added];
+  };
+
+  triangulate([&](const Polygon2D& piece, const VertexTriangle& triangle) {
+    result->indices.push_back(IndexOf(piece, triangle.a));
+    result->indices.push_back(IndexOf(piece, triangle.b));
+    result->indices.push_back(IndexOf(piece, triangle.c));
+  });
 }
 
 }  // namespace
 
+TriangulationContext::TriangulationContext() :
+    TriangulationContext(std::pmr::new_delete_resource()) {}
+
+TriangulationContext::TriangulationContext(
+    std::pmr::memory_resource* upstream) :
+    memory_(std::make_unique<RetainingMemoryResource>(upstream)) {}
+
+TriangulationContext::~TriangulationContext() = default;
+
+std::pmr::memory_resource* TriangulationContext::memory_resource() const {
+  return memory_.get();
+}
+
 // Algorithm is based on monotone triangulation
 // https://neerc.ifmo.ru/wiki/index.php?title=Триангуляция_полигонов_(ушная_%2B_монотонная)
 // The main idea:
@@ -38,22 +512,275 @@ std::optional<Triangle2D> AsTriangle(const Polygon2D& polygon) {
 //   2. decomosing simple polygons to y-monotone polygons (O(NlogN))
 //   3. greedily triangulating each y-monotone polygon (O(N))
 // (N - number of vertices, M - number of self-intersections)
-std::vector<Triangle2D> Triangulate(const std::vector<Point2D>& polygon_v) {
+// Small simple polygons and pieces are ear clipped instead (O(N^2)),
+// small simple input is found by pairwise check and skips step 1 too
+template<class T>
+std::vector<BasicTriangle2D<T> > Triangulate(
+    const std::vector<BasicPoint2D<T> >& polygon_v) {
+  return Triangulate(polygon_v, TriangulationOptions());
+}
+
+template<class T>
+std::vector<BasicTriangle2D<T> > Triangulate(
+    const std::vector<BasicPoint2D<T> >& polygon_v,
+    const TriangulationOptions& options) {
   if (polygon_v.size() < 3)
     return {};
-  Polygon2D polygon(polygon_v);
-  std::list<Polygon2D> simple_polygons = ResolveIntersections(polygon);
-  std::vector<Triangle2D> triangles;
-  for (const Polygon2D& simple_polygon : simple_polygons) {
-    std::list<Polygon2D> y_monotones = DecomposeToYMonotones(AsVector(simple_polygon));
-    for (const Polygon2D& y_monotone : y_monotones)
-      for (const Polygon2D& triangle_polygon : TriangulateYMonotone(y_monotone)) {
-        std::optional<Triangle2D> triangle = AsTriangle(triangle_polygon);
-        if (triangle)
-          triangles.push_back(triangle.value());
-      }
+  std::vector<BasicTriangle2D<T> > triangles;
+  TriangulateImpl(polygon_v.data(), polygon_v.data() + polygon_v.size(),
+                  options, ConsumePoints([&](const Triangle2D& triangle) {
+    triangles.push_back(FromTriangle2D<T>(triangle));
+  }));
+  return triangles;
+}
+
+template<class T>
+void Triangulate(const std::vector<BasicPoint2D<T> >& polygon_v,
+                 BasicIndexedTriangles2D<T>* result) {
+  Triangulate(polygon_v, TriangulationOptions(), result);
+}
+
+template<class T>
+void Triangulate(const std::vector<BasicPoint2D<T> >& polygon_v,
+                 const TriangulationOptions& options,
+                 BasicIndexedTriangles2D<T>* result) {
+  assert(result);
+  result->points = polygon_v;
+  result->indices.clear();
+  if (polygon_v.size() < 3)
+    return;
+
+  TriangulateIndexed(options, result, [&](auto consume) {
+    TriangulateImpl(polygon_v.data(), polygon_v.data() + polygon_v.size(),
+                    options, consume);
+  });
+}
+
+template<class T>
+void Triangulate(
+    const BasicPoint2D<T>* first, const BasicPoint2D<T>* last,
+    const TriangulationOptions& options,
+    const std::function<void(const BasicTriangle2D<T>&)>& sink) {
+  if (last - first < 3)
+    return;
+  TriangulateImpl(first, last, options,
+                  ConsumePoints([&](const Triangle2D& triangle) {
+    sink(FromTriangle2D<T>(triangle));
+  }));
+}
+
+bool TriangulateFile(const std::string& polygon_path,
+                     const std::string& triangles_path,
+                     const TriangulationOptions& options) {
+  // Points and triangles are read and written as arrays of doubles
+  static_assert(sizeof(Point2D) == 2 * sizeof(double));
+  static_assert(sizeof(Triangle2D) == 3 * sizeof(Point2D));
+  const MappedFile polygon_file(polygon_path);
+  if (!polygon_file.IsOpen() || polygon_file.Size() % sizeof(Point2D) != 0)
+    return false;
+  // Too big for the stack of a worker thread
+  auto triangles_file = std::make_unique<BufferedFileWriter>(triangles_path);
+  if (!triangles_file->IsOpen())
+    return false;
+  const Point2D* first = static_cast<const Point2D*>(polygon_file.Data());
+  Triangulate<double>(first, first + polygon_file.Size() / sizeof(Point2D),
+                      options, [&](const Triangle2D& triangle) {
+    triangles_file->Write(&triangle, sizeof(Triangle2D));
+  });
+  return triangles_file->Close();
+}
+
+template<class T>
+std::vector<BasicTriangle2D<T> > TriangulateWithHoles(
+    const std::vector<BasicPoint2D<T> >& polygon_v,
+    const std::vector<std::vector<BasicPoint2D<T> > >& holes_v) {
+  return TriangulateWithHoles(polygon_v, holes_v, TriangulationOptions());
+}
+
+template<class T>
+std::vector<BasicTriangle2D<T> > TriangulateWithHoles(
+    const std::vector<BasicPoint2D<T> >& polygon_v,
+    const std::vector<std::vector<BasicPoint2D<T> > >& holes_v,
+    const TriangulationOptions& options) {
+  if (polygon_v.size() < 3)
+    return {};
+  std::vector<BasicTriangle2D<T> > triangles;
+  TriangulateWithHolesImpl(polygon_v, holes_v, options,
+                           ConsumePoints([&](const Triangle2D& triangle) {
+    triangles.push_back(FromTriangle2D<T>(triangle));
+  }));
+  return triangles;
+}
+
+template<class T>
+void TriangulateWithHoles(
+    const std::vector<BasicPoint2D<T> >& polygon_v,
+    const std::vector<std::vector<BasicPoint2D<T> > >& holes_v,
+    const TriangulationOptions& options,
+    BasicIndexedTriangles2D<T>* result) {
+  assert(result);
+  result->points = polygon_v;
+  for (const std::vector<BasicPoint2D<T> >& hole_v : holes_v)
+    result->points.insert(result->points.end(), hole_v.begin(),
+                          hole_v.end());
+  result->indices.clear();
+  if (polygon_v.size() < 3)
+    return;
+
+  TriangulateIndexed(options, result, [&](auto consume) {
+    TriangulateWithHolesImpl(polygon_v, holes_v, options, consume);
+  });
+}
+
+template<class T>
+bool IsValidPolygonWithHoles(
+    const std::vector<BasicPoint2D<T> >& polygon_v,
+    const std::vector<std::vector<BasicPoint2D<T> > >& holes_v,
+    std::string* error) {
+  auto Reject = [&](const std::string& reason) {
+    if (error)
+      *error = reason;
+    return false;
+  };
+  if (polygon_v.size() < 3)
+    return true;
+
+  std::pmr::memory_resource* memory = std::pmr::get_default_resource();
+  std::pmr::vector<Polygon2D> holes(memory);
+  // Indices of the kept holes in holes_v
+  std::vector<size_t> hole_indices;
+  for (size_t i = 0; i < holes_v.size(); i++) {
+    Polygon2D hole = Polygon2D::HoleFromRing(
+        holes_v[i].data(), holes_v[i].data() + holes_v[i].size(), memory);
+    if (hole.Size() >= 3) {
+      holes.push_back(std::move(hole));
+      hole_indices.push_back(i);
+    }
   }
+  // Self-intersections of a polygon without holes are resolved
+  if (holes.empty())
+    return true;
+
+  const Polygon2D polygon = Polygon2D::FromRing(
+      polygon_v.data(), polygon_v.data() + polygon_v.size(), memory);
+  if (polygon.Size() < 3)
+    return Reject("polygon has less than 3 distinct vertices");
+  const std::optional<RingsDefect> defect =
+      CheckPolygonWithHoles(polygon, holes, memory);
+  if (!defect)
+    return true;
+  if (defect->type == RingsDefect::INTERSECTION)
+    return Reject("rings cross or touch at " + ToString(defect->point));
+  return Reject("hole " + std::to_string(hole_indices[defect->hole]) +
+                " is outside the polygon or inside another hole");
+}
+
+template<class T>
+std::vector<std::vector<BasicTriangle2D<T> > > TriangulateBatch(
+    const std::vector<std::vector<BasicPoint2D<T> > >& polygons,
+    size_t num_threads) {
+  TriangulationOptions options;
+  options.num_threads = num_threads;
+  return TriangulateBatch(polygons, options);
+}
+
+template<class T>
+std::vector<std::vector<BasicTriangle2D<T> > > TriangulateBatch(
+    const std::vector<std::vector<BasicPoint2D<T> > >& polygons,
+    const TriangulationOptions& options) {
+  std::vector<std::vector<BasicTriangle2D<T> > > triangles(polygons.size());
+  ForEachOfBatch(polygons.size(), options,
+                 [&](size_t i, const TriangulationOptions& polygon_options) {
+    triangles[i] = Triangulate(polygons[i], polygon_options);
+  });
   return triangles;
 }
 
+template<class T>
+void TriangulateBatch(
+    const std::vector<std::vector<BasicPoint2D<T> > >& polygons,
+    const TriangulationOptions& options,
+    std::vector<BasicIndexedTriangles2D<T> >* results) {
+  assert(results);
+  results->resize(polygons.size());
+  ForEachOfBatch(polygons.size(), options,
+                 [&](size_t i, const TriangulationOptions& polygon_options) {
+    Triangulate(polygons[i], polygon_options, &(*results)[i]);
+  });
+}
+
+template<class T>
+void TriangulateBatch(
+    const std::vector<BasicPolygonWithHoles2D<T> >& polygons,
+    const TriangulationOptions& options,
+    std::vector<BasicIndexedTriangles2D<T> >* results,
+    std::vector<std::string>* errors) {
+  assert(results);
+  results->resize(polygons.size());
+  if (errors)
+    errors->assign(polygons.size(), std::string());
+  ForEachOfBatch(polygons.size(), options,
+                 [&](size_t i, const TriangulationOptions& polygon_options) {
+    const BasicPolygonWithHoles2D<T>& polygon = polygons[i];
+    BasicIndexedTriangles2D<T>& result = (*results)[i];
+    if (errors && !polygon.holes.empty() &&
+        !IsValidPolygonWithHoles(polygon.ring, polygon.holes,
+                                 &(*errors)[i])) {
+      result.points.clear();
+      result.indices.clear();
+      return;
+    }
+    TriangulateWithHoles(polygon.ring, polygon.holes, polygon_options,
+                         &result);
+  });
+}
+
+#define INSTANTIATE_TRIANGULATION(T) \
+  template std::vector<BasicTriangle2D<T> > Triangulate( \
+      const std::vector<BasicPoint2D<T> >&); \
+  template std::vector<BasicTriangle2D<T> > Triangulate( \
+      const std::vector<BasicPoint2D<T> >&, const TriangulationOptions&); \
+  template void Triangulate(const std::vector<BasicPoint2D<T> >&, \
+                            BasicIndexedTriangles2D<T>*); \
+  template void Triangulate(const std::vector<BasicPoint2D<T> >&, \
+                            const TriangulationOptions&, \
+                            BasicIndexedTriangles2D<T>*); \
+  template void Triangulate( \
+      const BasicPoint2D<T>*, const BasicPoint2D<T>*, \
+      const TriangulationOptions&, \
+      const std::function<void(const BasicTriangle2D<T>&)>&); \
+  template std::vector<BasicTriangle2D<T> > TriangulateWithHoles( \
+      const std::vector<BasicPoint2D<T> >&, \
+      const std::vector<std::vector<BasicPoint2D<T> > >&); \
+  template std::vector<BasicTriangle2D<T> > TriangulateWithHoles( \
+      const std::vector<BasicPoint2D<T> >&, \
+      const std::vector<std::vector<BasicPoint2D<T> > >&, \
+      const TriangulationOptions&); \
+  template void TriangulateWithHoles( \
+      const std::vector<BasicPoint2D<T> >&, \
+      const std::vector<std::vector<BasicPoint2D<T> > >&, \
+      const TriangulationOptions&, BasicIndexedTriangles2D<T>*); \
+  template bool IsValidPolygonWithHoles( \
+      const std::vector<BasicPoint2D<T> >&, \
+      const std::vector<std::vector<BasicPoint2D<T> > >&, std::string*); \
+  template std::vector<std::vector<BasicTriangle2D<T> > > TriangulateBatch( \
+      const std::vector<std::vector<BasicPoint2D<T> > >&, size_t); \
+  template std::vector<std::vector<BasicTriangle2D<T> > > TriangulateBatch( \
+      const std::vector<std::vector<BasicPoint2D<T> > >&, \
+      const TriangulationOptions&); \
+  template void TriangulateBatch( \
+      const std::vector<std::vector<BasicPoint2D<T> > >&, \
+      const TriangulationOptions&, \
+      std::vector<BasicIndexedTriangles2D<T> >*); \
+  template void TriangulateBatch( \
+      const std::vector<BasicPolygonWithHoles2D<T> >&, \
+      const TriangulationOptions&, \
+      std::vector<BasicIndexedTriangles2D<T> >*, std::vector<std::string>*);
+
+INSTANTIATE_TRIANGULATION(float)
+INSTANTIATE_TRIANGULATION(double)
+INSTANTIATE_TRIANGULATION(int32_t)
+
+#undef INSTANTIATE_TRIANGULATION
+
 }  //geom
@@ -0,0 +1,380 @@
+#include <vertex_kernels.h>
+
+#include <geom_utils.h>
+
+#include <algorithm>
+#include <cmath>
+
+// Vector kernels are built with per-function target attributes,
+// so the library itself doesn't require AVX2
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#define VERTEX_KERNELS_X86
+#include <immintrin.h>
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2,fma")))
+#endif
+
+namespace geom {
+
+namespace {
+
+using VertexType = Polygon2D::VertexType;
+
+enum VertexFlags {
+  START_FLAG = 1,
+  END_FLAG = 2,
+  REFLEX_FLAG = 4,
+  // Next vertex is above, used by the regular ones
+  LEFT_FLAG = 8,
+  // Orientation is within the filter bound
+  UNSURE_FLAG = 16
+};
+
+constexpr int kTypeFlags = START_FLAG | END_FLAG | REFLEX_FLAG | LEFT_FLAG;
+
+// Indexed by type flags, START and END never come together
+constexpr VertexType kTypes[kTypeFlags + 1] = {
+  Polygon2D::RIGHT_REGULAR, Polygon2D::START,
+  Polygon2D::END, Polygon2D::START,
+  Polygon2D::RIGHT_REGULAR, Polygon2D::SPLIT,
+  Polygon2D::MERGE, Polygon2D::SPLIT,
+  Polygon2D::LEFT_REGULAR, Polygon2D::START,
+  Polygon2D::END, Polygon2D::START,
+  Polygon2D::LEFT_REGULAR, Polygon2D::SPLIT,
+  Polygon2D::MERGE, Polygon2D::SPLIT
+};
+
+// YFirstPoint2DComparator on coordinates
+bool YLess(double ax, double ay, double bx, double by) {
+  return ay < by || (ay == by && ax > bx);
+}
+
+// Flags of vertex i, its previous vertex is at i and the next one at i + 2
+int VertexFlagsAt(const double* x, const double* y, size_t i) {
+  const double px = x[i], py = y[i];
+  const double cx = x[i + 1], cy = y[i + 1];
+  const double nx = x[i + 2], ny = y[i + 2];
+  int flags = 0;
+  if (YLess(px, py, cx, cy) && YLess(nx, ny, cx, cy))
+    flags |= START_FLAG;
+  if (YLess(cx, cy, px, py) && YLess(cx, cy, nx, ny))
+    flags |= END_FLAG;
+  if (YLess(cx, cy, nx, ny))
+    flags |= LEFT_FLAG;
+  const double left = (px - cx) * (ny - cy);
+  const double right = (py - cy) * (nx - cx);
+  const double det = left - right;
+  const double bound = kCrossProductErrorBound *
+                       (std::abs(left) + std::abs(right));
+  if (det < -bound)
+    flags |= REFLEX_FLAG;
+  else if (det <= bound && bound != 0)
+    flags |= UNSURE_FLAG;
+  return flags;
+}
+
+// Orientation matters only for START and END kinds
+VertexType TypeFromFlags(const double* x, const double* y, size_t i,
+                         int flags) {
+  if ((flags & UNSURE_FLAG) && (flags & (START_FLAG | END_FLAG)) &&
+      Orient2D({x[i + 1], y[i + 1]}, {x[i], y[i]}, {x[i + 2], y[i + 2]}) < 0)
+    flags |= REFLEX_FLAG;
+  return kTypes[flags & kTypeFlags];
+}
+
+void ClassifyScalar(const double* x, const double* y, size_t begin,
+                    size_t end, VertexType* types) {
+  for (size_t i = begin; i < end; i++)
+    types[i] = TypeFromFlags(x, y, i, VertexFlagsAt(x, y, i));
+}
+
+// Lanes of the vector kernels come as bit masks of every flag
+void TypesFromMasks(const double* x, const double* y, size_t i, int lanes,
+                    int start, int end, int reflex, int left, int unsure,
+                    VertexType* types) {
+  for (int lane = 0; lane < lanes; lane++) {
+    const int flags = ((start >> lane) & 1) * START_FLAG |
+                      ((end >> lane) & 1) * END_FLAG |
+                      ((reflex >> lane) & 1) * REFLEX_FLAG |
+                      ((left >> lane) & 1) * LEFT_FLAG |
+                      ((unsure >> lane) & 1) * UNSURE_FLAG;
+    types[i + lane] = TypeFromFlags(x, y, i + lane, flags);
+  }
+}
+
+// Sum of cross products x[i] * y[i + 1] - x[i + 1] * y[i]
+// keeping the rounding errors of every operation in a separate sum
+// (T. Ogita, S. M. Rump, S. Oishi, Accurate Sum and Dot Product)
+struct AreaSum {
+  double sum = 0;
+  double error = 0;
+
+  // a + b rounded, the rounding error is added to the error sum
+  double TwoSum(double a, double b) {
+    const double s = a + b;
+    const double b_virtual = s - a;
+    const double a_virtual = s - b_virtual;
+    error += (a - a_virtual) + (b - b_virtual);
+    return s;
+  }
+
+  void Add(double ax, double ay, double bx, double by) {
+    const double lhs = ax * by;
+    const double rhs = bx * ay;
+    error += std::fma(ax, by, -lhs) - std::fma(bx, ay, -rhs);
+    sum = TwoSum(sum, TwoSum(lhs, -rhs));
+  }
+
+  void Add(const AreaSum& other) {
+    sum = TwoSum(sum, other.sum);
+    error += other.error;
+  }
+
+  double Value() const { return sum + error; }
+};
+
+void AddAreaScalar(const double* x, const double* y, size_t begin,
+                   size_t end, AreaSum* area) {
+  for (size_t i = begin; i < end; i++)
+    area->Add(x[i + 1], y[i + 1], x[i + 2], y[i + 2]);
+}
+
+#ifdef VERTEX_KERNELS_X86
+
+SSE2_TARGET __m128d YLessSse2(__m128d ax, __m128d ay, __m128d bx,
+                              __m128d by) {
+  return _mm_or_pd(_mm_cmplt_pd(ay, by),
+                   _mm_and_pd(_mm_cmpeq_pd(ay, by), _mm_cmpgt_pd(ax, bx)));
+}
+
+SSE2_TARGET void ClassifySse2(const double* x, const double* y, size_t size,
+                              VertexType* types) {
+  const __m128d abs_mask = _mm_castsi128_pd(
+      _mm_set1_epi64x(0x7fffffffffffffffLL));
+  const __m128d error_bound = _mm_set1_pd(kCrossProductErrorBound);
+  const __m128d zero = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    const __m128d px = _mm_loadu_pd(x + i), py = _mm_loadu_pd(y + i);
+    const __m128d cx = _mm_loadu_pd(x + i + 1), cy = _mm_loadu_pd(y + i + 1);
+    const __m128d nx = _mm_loadu_pd(x + i + 2), ny = _mm_loadu_pd(y + i + 2);
+    const __m128d prev_lower = YLessSse2(px, py, cx, cy);
+    const __m128d next_lower = YLessSse2(nx, ny, cx, cy);
+    const __m128d prev_upper = YLessSse2(cx, cy, px, py);
+    const __m128d next_upper = YLessSse2(cx, cy, nx, ny);
+    const __m128d left = _mm_mul_pd(_mm_sub_pd(px, cx), _mm_sub_pd(ny, cy));
+    const __m128d right = _mm_mul_pd(_mm_sub_pd(py, cy), _mm_sub_pd(nx, cx));
+    const __m128d det = _mm_sub_pd(left, right);
+    const __m128d bound = _mm_mul_pd(
+        error_bound, _mm_add_pd(_mm_and_pd(left, abs_mask),
+                                _mm_and_pd(right, abs_mask)));
+    const __m128d reflex = _mm_cmplt_pd(det, _mm_sub_pd(zero, bound));
+    const __m128d unsure = _mm_andnot_pd(
+        reflex, _mm_and_pd(_mm_cmple_pd(det, bound),
+                           _mm_cmpneq_pd(bound, zero)));
+    TypesFromMasks(x, y, i, 2,
+                   _mm_movemask_pd(_mm_and_pd(prev_lower, next_lower)),
+                   _mm_movemask_pd(_mm_and_pd(prev_upper, next_upper)),
+                   _mm_movemask_pd(reflex), _mm_movemask_pd(next_upper),
+                   _mm_movemask_pd(unsure), types);
+  }
+  ClassifyScalar(x, y, i, size, types);
+}
+
+// Exact products without FMA by splitting the factors in halves
+// (Dekker's TwoProduct)
+SSE2_TARGET __m128d ProductErrorSse2(__m128d a, __m128d b, __m128d product) {
+  const __m128d splitter = _mm_set1_pd(134217729.0);  // 2^27 + 1
+  const __m128d a_scaled = _mm_mul_pd(splitter, a);
+  const __m128d a_high = _mm_sub_pd(a_scaled, _mm_sub_pd(a_scaled, a));
+  const __m128d a_low = _mm_sub_pd(a, a_high);
+  const __m128d b_scaled = _mm_mul_pd(splitter, b);
+  const __m128d b_high = _mm_sub_pd(b_scaled, _mm_sub_pd(b_scaled, b));
+  const __m128d b_low = _mm_sub_pd(b, b_high);
+  __m128d error = _mm_sub_pd(_mm_mul_pd(a_high, b_high), product);
+  error = _mm_add_pd(error, _mm_mul_pd(a_high, b_low));
+  error = _mm_add_pd(error, _mm_mul_pd(a_low, b_high));
+  return _mm_add_pd(error, _mm_mul_pd(a_low, b_low));
+}
+
+SSE2_TARGET __m128d TwoSumSse2(__m128d a, __m128d b, __m128d* error) {
+  const __m128d sum = _mm_add_pd(a, b);
+  const __m128d b_virtual = _mm_sub_pd(sum, a);
+  const __m128d a_virtual = _mm_sub_pd(sum, b_virtual);
+  *error = _mm_add_pd(*error, _mm_add_pd(_mm_sub_pd(a, a_virtual),
+                                         _mm_sub_pd(b, b_virtual)));
+  return sum;
+}
+
+SSE2_TARGET void AddAreaSse2(const double* x, const double* y, size_t size,
+                             AreaSum* area) {
+  __m128d sum = _mm_setzero_pd();
+  __m128d error = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 2 <= size; i += 2) {
+    const __m128d ax = _mm_loadu_pd(x + i + 1), ay = _mm_loadu_pd(y + i + 1);
+    const __m128d bx = _mm_loadu_pd(x + i + 2), by = _mm_loadu_pd(y + i + 2);
+    const __m128d lhs = _mm_mul_pd(ax, by);
+    const __m128d rhs = _mm_mul_pd(bx, ay);
+    error = _mm_add_pd(error, _mm_sub_pd(ProductErrorSse2(ax, by, lhs),
+                                         ProductErrorSse2(bx, ay, rhs)));
+    const __m128d term = TwoSumSse2(lhs, _mm_sub_pd(_mm_setzero_pd(), rhs),
+                                    &error);
+    sum = TwoSumSse2(sum, term, &error);
+  }
+  double sums[2], errors[2];
+  _mm_storeu_pd(sums, sum);
+  _mm_storeu_pd(errors, error);
+  for (int lane = 0; lane < 2; lane++)
+    area->Add(AreaSum{sums[lane], errors[lane]});
+  AddAreaScalar(x, y, i, size, area);
+}
+
+AVX2_TARGET __m256d YLessAvx2(__m256d ax, __m256d ay, __m256d bx,
+                              __m256d by) {
+  return _mm256_or_pd(
+      _mm256_cmp_pd(ay, by, _CMP_LT_OQ),
+      _mm256_and_pd(_mm256_cmp_pd(ay, by, _CMP_EQ_OQ),
+                    _mm256_cmp_pd(ax, bx, _CMP_GT_OQ)));
+}
+
+AVX2_TARGET void ClassifyAvx2(const double* x, const double* y, size_t size,
+                              VertexType* types) {
+  const __m256d abs_mask = _mm256_castsi256_pd(
+      _mm256_set1_epi64x(0x7fffffffffffffffLL));
+  const __m256d error_bound = _mm256_set1_pd(kCrossProductErrorBound);
+  const __m256d zero = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const __m256d px = _mm256_loadu_pd(x + i), py = _mm256_loadu_pd(y + i);
+    const __m256d cx = _mm256_loadu_pd(x + i + 1);
+    const __m256d cy = _mm256_loadu_pd(y + i + 1);
+    const __m256d nx = _mm256_loadu_pd(x + i + 2);
+    const __m256d ny = _mm256_loadu_pd(y + i + 2);
+    const __m256d prev_lower = YLessAvx2(px, py, cx, cy);
+    const __m256d next_lower = YLessAvx2(nx, ny, cx, cy);
+    const __m256d prev_upper = YLessAvx2(cx, cy, px, py);
+    const __m256d next_upper = YLessAvx2(cx, cy, nx, ny);
+    // Same rounding as the scalar products, no FMA contraction here
+    const __m256d left = _mm256_mul_pd(_mm256_sub_pd(px, cx),
+                                       _mm256_sub_pd(ny, cy));
+    const __m256d right = _mm256_mul_pd(_mm256_sub_pd(py, cy),
+                                        _mm256_sub_pd(nx, cx));
+    const __m256d det = _mm256_sub_pd(left, right);
+    const __m256d bound = _mm256_mul_pd(
+        error_bound, _mm256_add_pd(_mm256_and_pd(left, abs_mask),
+                                   _mm256_and_pd(right, abs_mask)));
+    const __m256d reflex = _mm256_cmp_pd(det, _mm256_sub_pd(zero, bound),
+                                         _CMP_LT_OQ);
+    const __m256d unsure = _mm256_andnot_pd(
+        reflex, _mm256_and_pd(_mm256_cmp_pd(det, bound, _CMP_LE_OQ),
+                              _mm256_cmp_pd(bound, zero, _CMP_NEQ_OQ)));
+    TypesFromMasks(x, y, i, 4,
+                   _mm256_movemask_pd(_mm256_and_pd(prev_lower, next_lower)),
+                   _mm256_movemask_pd(_mm256_and_pd(prev_upper, next_upper)),
+                   _mm256_movemask_pd(reflex), _mm256_movemask_pd(next_upper),
+                   _mm256_movemask_pd(unsure), types);
+  }
+  ClassifyScalar(x, y, i, size, types);
+}
+
+AVX2_TARGET __m256d TwoSumAvx2(__m256d a, __m256d b, __m256d* error) {
+  const __m256d sum = _mm256_add_pd(a, b);
+  const __m256d b_virtual = _mm256_sub_pd(sum, a);
+  const __m256d a_virtual = _mm256_sub_pd(sum, b_virtual);
+  *error = _mm256_add_pd(*error, _mm256_add_pd(_mm256_sub_pd(a, a_virtual),
+                                               _mm256_sub_pd(b, b_virtual)));
+  return sum;
+}
+
+AVX2_TARGET void AddAreaAvx2(const double* x, const double* y, size_t size,
+                             AreaSum* area) {
+  __m256d sum = _mm256_setzero_pd();
+  __m256d error = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= size; i += 4) {
+    const __m256d ax = _mm256_loadu_pd(x + i + 1);
+    const __m256d ay = _mm256_loadu_pd(y + i + 1);
+    const __m256d bx = _mm256_loadu_pd(x + i + 2);
+    const __m256d by = _mm256_loadu_pd(y + i + 2);
+    const __m256d lhs = _mm256_mul_pd(ax, by);
+    const __m256d rhs = _mm256_mul_pd(bx, ay);
+    error = _mm256_add_pd(error, _mm256_sub_pd(_mm256_fmsub_pd(ax, by, lhs),
+                                               _mm256_fmsub_pd(bx, ay, rhs)));
+    const __m256d term = TwoSumAvx2(
+        lhs, _mm256_sub_pd(_mm256_setzero_pd(), rhs), &error);
+    sum = TwoSumAvx2(sum, term, &error);
+  }
+  double sums[4], errors[4];
+  _mm256_storeu_pd(sums, sum);
+  _mm256_storeu_pd(errors, error);
+  for (int lane = 0; lane < 4; lane++)
+    area->Add(AreaSum{sums[lane], errors[lane]});
+  AddAreaScalar(x, y, i, size, area);
+}
+
+#endif  // VERTEX_KERNELS_X86
+
+VertexKernelsIsa DetectIsa() {
+#ifdef VERTEX_KERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+    return AVX2_KERNELS;
+  if (__builtin_cpu_supports("sse2"))
+    return SSE2_KERNELS;
+#endif
+  return SCALAR_KERNELS;
+}
+
+}  // namespace
+
+VertexKernelsIsa BestVertexKernelsIsa() {
+  static const VertexKernelsIsa isa = DetectIsa();
+  return isa;
+}
+
+// Isa above the supported one falls back to the best supported
+double DoubleSignedArea(const RingCoordinates& ring, VertexKernelsIsa isa) {
+  const double* x = ring.X();
+  const double* y = ring.Y();
+  const size_t size = ring.Size();
+  AreaSum area;
+  switch (std::min(isa, BestVertexKernelsIsa())) {
+#ifdef VERTEX_KERNELS_X86
+    case AVX2_KERNELS:
+      AddAreaAvx2(x, y, size, &area);
+      break;
+    case SSE2_KERNELS:
+      AddAreaSse2(x, y, size, &area);
+      break;
+#endif
+    default:
+      AddAreaScalar(x, y, 0, size, &area);
+      break;
+  }
+  return area.Value();
+}
+
+void ClassifyVertices(const RingCoordinates& ring, size_t begin, size_t end,
+                      Polygon2D::VertexType* types, VertexKernelsIsa isa) {
+  // Kernels see the vertices from begin on as a whole ring
+  const double* x = ring.X() + begin;
+  const double* y = ring.Y() + begin;
+  const size_t size = end - begin;
+  switch (std::min(isa, BestVertexKernelsIsa())) {
+#ifdef VERTEX_KERNELS_X86
+    case AVX2_KERNELS:
+      ClassifyAvx2(x, y, size, types);
+      break;
+    case SSE2_KERNELS:
+      ClassifySse2(x, y, size, types);
+      break;
+#endif
+    default:
+      ClassifyScalar(x, y, 0, size, types);
+      break;
+  }
+}
+
+}  // geom
@@ -0,0 +1,35 @@
+#ifndef VERTEX_KERNELS_H
+#define VERTEX_KERNELS_H
+
+#include <polygon2d.h>
+
+#include <cstddef>
+
+namespace geom {
+
+// Instruction sets of the kernels, every one gives the same vertex types
+enum VertexKernelsIsa {
+  SCALAR_KERNELS,
+  SSE2_KERNELS,
+  AVX2_KERNELS
+};
+
+// The best one supported by the CPU, detected on the first call
+VertexKernelsIsa BestVertexKernelsIsa();
+
+// Twice the signed area, positive for counterclockwise rings
+// Products and sums are accumulated with their rounding errors,
+// as in twice the precision, only the last bits depend on the isa
+double DoubleSignedArea(const RingCoordinates& ring,
+                        VertexKernelsIsa isa = BestVertexKernelsIsa());
+
+// Types of vertices [begin, end) in ring order, types[0] is the one of begin
+// Orientation is filtered as in Orient2D
+// and the uncertain vertices are finished by Orient2D itself
+void ClassifyVertices(const RingCoordinates& ring, size_t begin, size_t end,
+                      Polygon2D::VertexType* types,
+                      VertexKernelsIsa isa = BestVertexKernelsIsa());
+
+}  // geom
+
+#endif  // VERTEX_KERNELS_H